@@ -100,12 +100,26 @@ namespace mongo {
         return false;
     }
 
+    /* compares each field name with name while finding where it ends, so every name is read once
+       rather than once by strcmp and again by strlen when stepping to the next element.
+       only name.size() bytes of name are read.
+    */
     inline BSONElement BSONObj::getField(const StringData& name) const {
-        BSONObjIterator i(*this);
-        while ( i.more() ) {
-            BSONElement e = i.next();
-            if ( strcmp(e.fieldName(), name.data()) == 0 )
-                return e;
+        const char *n = name.data();
+        const unsigned len = name.size();
+        const char *p = objdata() + 4;
+        const char *end = objdata() + objsize();
+        while ( p < end && *p != EOO ) {
+            const char *f = p + 1;
+            unsigned i = 0;
+            while ( i < len && f[i] == n[i] )
+                i++;
+            const char *z = f + i;
+            if ( i == len && *z == 0 )
+                return BSONElement( p, (int) len + 1, BSONElement::FieldNameSizeTag() );
+            while ( *z )
+                z++;
+            p += BSONElement( p, (int) ( z - f ) + 1, BSONElement::FieldNameSizeTag() ).size();
         }
         return BSONElement();
     }
@@ -509,9 +523,13 @@ namespace mongo {
         if ( e.eoo() ) {
             const char *p = strchr(name, '.');
             if ( p ) {
-                string left(name, p-name);
-                BSONObj sub = getObjectField(left.c_str());
-                return sub.isEmpty() ? BSONElement() : sub.getFieldDotted(p+1);
+                // getField() reads only the first p-name bytes, so no copy of the prefix is needed
+                BSONElement sub = getField( StringData( name, p - name ) );
+                BSONType t = sub.type();
+                if ( t != Object && t != Array )
+                    return BSONElement();
+                BSONObj o = sub.embeddedObject();
+                return o.isEmpty() ? BSONElement() : o.getFieldDotted(p+1);
             }
         }
 
@@ -89,6 +89,7 @@ public:
     string toString( bool includeFieldName = true, bool full=false) const;
     void toString(StringBuilder& s, bool includeFieldName = true, bool full=false) const;
     string jsonString( JsonStringFormat format, bool includeFieldNames = true, int pretty = 0 ) const;
+    void jsonString( StringBuilder& s, JsonStringFormat format, bool includeFieldNames = true, int pretty = 0 ) const;
     operator string() const { return toString(); }
 
     /** Returns the type of the element */
@@ -373,6 +374,14 @@ public:
         totalSize = -1;
     }
 
+    struct FieldNameSizeTag {}; // For disambiguation with ctor taking 'maxLen' above.
+
+    /** Construct a BSONElement where you already know the length of the name. The value
+        passed here includes the null terminator. */
+    BSONElement(const char *d, int fieldNameSize, FieldNameSizeTag)
+        : data(d), fieldNameSize_(fieldNameSize), totalSize(-1) {
+    }
+
     string _asCode() const;
     OpTime _opTime() const;
 
@@ -67,6 +67,20 @@ namespace mongo {
      */
     class BSONObj {
     public:
+
+        /** frees the malloc'ed buffer an owned BSONObj points into when the last BSONObj sharing it goes */
+        class Holder {
+        public:
+            Holder( const char *objdata ) :
+            _objdata( objdata ) {
+            }
+            ~Holder() {
+                free((void *)_objdata);
+                _objdata = 0;
+            }
+        private:
+            const char *_objdata;
+        };
         
         /** Construct a BSONObj from data in the proper format. 
             @param ifree true if the BSONObj should free() the msgdata when 
@@ -78,6 +92,14 @@ namespace mongo {
 
         BSONObj(const Record *r);
 
+        /** an owned BSONObj for an object somewhere inside the buffer holder frees, such as a
+            received message (see DbMessage::shareBuffer).  getOwned() on it doesn't copy.
+        */
+        BSONObj(const char *objdata, const boost::shared_ptr< Holder >& holder) : _objdata( objdata ), _holder( holder ) {
+            if ( !isValid() )
+                _assertInvalid();
+        }
+
         /** Construct an empty BSONObj -- that is, {}. */
         BSONObj();
 
@@ -104,6 +126,9 @@ namespace mongo {
            getOwned().  getOwned() is a no-op if the buffer is already owned.  If not already owned, a malloc 
            and memcpy will result.
 
+           An owned BSONObj may also be a view of one object in a larger shared buffer, such as a
+           received message, which stays allocated while any BSONObj points into it.
+
            Most ways to create BSONObj's create 'owned' variants.  Unowned versions can be created with:
            (1) specifying true for the ifree parameter in the constructor
            (2) calling BSONObjBuilder::done().  Use BSONObjBuilder::obj() to get an owned copy
@@ -129,6 +154,8 @@ namespace mongo {
             @param pretty if true we try to add some lf's and indentation
         */
         string jsonString( JsonStringFormat format = Strict, int pretty = 0 ) const;
+        /** append the json for this object to s, so a caller formatting many objects can reuse one buffer */
+        void jsonString( StringBuilder& s, JsonStringFormat format = Strict, int pretty = 0 ) const;
 
         /** note: addFields always adds _id even if not specified */
         int addFields(BSONObj& from, set<string>& fields); /* returns n added */
@@ -165,6 +192,12 @@ namespace mongo {
         */
         BSONElement getField(const StringData& name) const;
 
+        /** Get several fields in one pass over the object, which is faster than a getField() call
+            for each.  fields[i] is set to the first element named fieldNames[i]; entries for names
+            not present are left as they were, so start them off as BSONElement().
+        */
+        void getFields(unsigned n, const char **fieldNames, BSONElement *fields) const;
+
         /** Get the field of the specified name. eoo() is true on the returned 
             element if not found. 
         */
@@ -384,19 +417,6 @@ namespace mongo {
         }
 
 private:
-        class Holder {
-        public:
-            Holder( const char *objdata ) :
-            _objdata( objdata ) {
-            }
-            ~Holder() {
-                free((void *)_objdata);
-                _objdata = 0;
-            }
-        private:
-            const char *_objdata;
-        };
-
         const char *_objdata;
         boost::shared_ptr< Holder > _holder;
 
@@ -111,6 +111,16 @@ namespace mongo {
             return *this;
         }
 
+        /** append a run of consecutive elements of another object with a single copy.
+            @param start rawdata() of the first element of the run
+            @param end   one past the last byte of the last element of the run
+        */
+        BSONObjBuilder& appendElementRun( const char *start, const char *end ) {
+            assert( start <= end );
+            _b.appendBuf((void*) start, end - start);
+            return *this;
+        }
+
         /** append an element but with a new name */
         BSONObjBuilder& appendAs(const BSONElement& e, const StringData& fieldName) {
             assert( !e.eoo() ); // do not append eoo, that would corrupt us. the builder auto appends when done() is called.
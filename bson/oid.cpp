@@ -85,9 +85,37 @@ namespace mongo {
         ourMachineAndPid = x;
     }
     
-    void OID::init() {
+    /* each thread takes a block of counter values from the shared counter at a time, so that
+       generating ids doesn't bounce the counter's cache line between cores on every insert.  the
+       values in a block belong to the one thread, so ids stay unique; they're just not handed out in
+       strict counter order across threads, which the time prefix never promised anyway.
+    */
+    struct OIDIncBlock {
+        enum { Size = 256 };
+        OIDIncBlock() : next(0), left(0) { }
+        unsigned next;
+        unsigned left;
+    };
+
+    static unsigned nextInc() {
         static AtomicUInt inc = (unsigned) security.getNonce();
+        // leaked so it outlives any static destructor that makes an id
+        static boost::thread_specific_ptr<OIDIncBlock> *blocks = new boost::thread_specific_ptr<OIDIncBlock>();
+
+        OIDIncBlock *b = blocks->get();
+        if ( b == 0 ) {
+            b = new OIDIncBlock();
+            blocks->reset( b );
+        }
+        if ( b->left == 0 ) {
+            b->next = inc.signedAdd( OIDIncBlock::Size ) - OIDIncBlock::Size;
+            b->left = OIDIncBlock::Size;
+        }
+        b->left--;
+        return b->next++;
+    }
 
+    void OID::init() {
         {
             unsigned t = (unsigned) time(0);
             unsigned char *T = (unsigned char *) &t;
@@ -100,7 +128,7 @@ namespace mongo {
         _machineAndPid = ourMachineAndPid;
 
         {
-            int new_inc = inc++;
+            unsigned new_inc = nextInc();
             unsigned char *T = (unsigned char *) &new_inc;
             _inc[0] = T[2];
             _inc[1] = T[1];
@@ -35,6 +35,7 @@ namespace mongo {
         inline AtomicUInt operator++(int);// postfix++
         inline AtomicUInt operator--(); // --prefix
         inline AtomicUInt operator--(int); // postfix--
+        inline AtomicUInt signedAdd(int by); // returns the new value
         
         inline void zero() { x = 0; } // TODO: this isn't thread safe
         
@@ -55,6 +56,10 @@ namespace mongo {
     AtomicUInt AtomicUInt::operator--(int){
         return InterlockedDecrement((volatile long*)&x)+1;
     }
+    AtomicUInt AtomicUInt::signedAdd(int by){
+        // InterlockedExchangeAdd returns the old value
+        return InterlockedExchangeAdd((volatile long*)&x, by)+by;
+    }
 #elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
     // this is in GCC >= 4.1
     AtomicUInt AtomicUInt::operator++(){
@@ -69,6 +74,9 @@ namespace mongo {
     AtomicUInt AtomicUInt::operator--(int){
         return __sync_fetch_and_add(&x, -1);
     }
+    AtomicUInt AtomicUInt::signedAdd(int by){
+        return __sync_add_and_fetch(&x, by);
+    }
 #elif defined(__GNUC__)  && (defined(__i386__) || defined(__x86_64__))
     // from boost 1.39 interprocess/detail/atomic.hpp
 
@@ -96,6 +104,9 @@ namespace mongo {
     AtomicUInt AtomicUInt::operator--(int){
         return atomic_int_helper(&x, -1);
     }
+    AtomicUInt AtomicUInt::signedAdd(int by){
+        return atomic_int_helper(&x, by)+by;
+    }
 #else
 #  error "unsupported compiler or platform"
 #endif
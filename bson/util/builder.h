@@ -49,11 +49,61 @@ namespace mongo {
 
     void msgasserted(int msgid, const char *msg);
 
+    /** Spare buffers of the default BufBuilder size, which builders take their initial buffer from
+        and give back when destroyed, instead of a malloc and free for every short lived builder.
+        Nothing is pooled unless the program supplies a way to find the current thread's pool with
+        setCurrentFn(); the server has one per request (see assembleResponse).
+        A buffer that escapes its builder through decouple() -- as when a BSONObjBuilder hands its
+        buffer to the BSONObj from obj() -- is an ordinary malloc'ed block that its new owner frees;
+        the pool just doesn't get it back.
+    */
+    class BufBuilderPool {
+    public:
+        enum { BufSize = 512, MaxBufs = 32 };
+
+        BufBuilderPool() : _n(0) { }
+        ~BufBuilderPool() {
+            while( _n )
+                free( _bufs[--_n] );
+        }
+
+        /** @return a BufSize buffer, or null if there are none spare */
+        char* take() { return _n ? _bufs[--_n] : 0; }
+
+        /** @return false if the pool is full, in which case the caller keeps (and frees) p */
+        bool giveBack( char *p ) {
+            if ( _n == MaxBufs )
+                return false;
+            _bufs[_n++] = p;
+            return true;
+        }
+
+        static BufBuilderPool* current() {
+            return Hook<0>::currentFn ? Hook<0>::currentFn() : 0;
+        }
+        static void setCurrentFn( BufBuilderPool* (*f)() ) { Hook<0>::currentFn = f; }
+
+    private:
+        // a template so the bson headers can define the hook without a .cpp of their own
+        template< int dummy > struct Hook { static BufBuilderPool* (*currentFn)(); };
+
+        char *_bufs[MaxBufs];
+        int _n;
+    };
+    template< int dummy > BufBuilderPool* (*BufBuilderPool::Hook< dummy >::currentFn)() = 0;
+
     class BufBuilder {
     public:
         BufBuilder(int initsize = 512) : size(initsize) {
             if ( size > 0 ) {
-                data = (char *) malloc(size);
+                data = 0;
+                if ( size == BufBuilderPool::BufSize ) {
+                    BufBuilderPool *p = BufBuilderPool::current();
+                    if ( p )
+                        data = p->take();
+                }
+                if ( data == 0 )
+                    data = (char *) malloc(size);
                 if( data == 0 )
                     msgasserted(10000, "out of memory BufBuilder");
             } else {
@@ -67,6 +117,13 @@ namespace mongo {
 
         void kill() {
             if ( data ) {
+                if ( size == BufBuilderPool::BufSize ) {
+                    BufBuilderPool *p = BufBuilderPool::current();
+                    if ( p && p->giveBack(data) ) {
+                        data = 0;
+                        return;
+                    }
+                }
                 free(data);
                 data = 0;
             }
@@ -236,6 +293,10 @@ namespace mongo {
         
         std::string str() const { return std::string(_buf.data, _buf.l); }
 
+        /** the text so far, without a copy.  not nul terminated, and only valid until the next write */
+        const char* data() const { return _buf.buf(); }
+        int len() const { return _buf.len(); }
+
     private:
         BufBuilder _buf;
 
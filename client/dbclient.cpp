@@ -23,6 +23,7 @@
 #include "../db/json.h"
 #include "../db/instance.h"
 #include "../util/md5.hpp"
+#include "../util/compress.h"
 #include "../db/dbmessage.h"
 #include "../db/cmdline.h"
 #include "connpool.h"
@@ -530,9 +531,32 @@ namespace mongo {
             failed = true;
             return false;
         }
+
+        if ( _compressionDefault ) {
+            try {
+                _negotiateCompression();
+            }
+            catch ( SocketException& ) {
+                stringstream ss;
+                ss << "couldn't connect to server " << _serverString << " (compression handshake)";
+                errmsg = ss.str();
+                failed = true;
+                return false;
+            }
+        }
         return true;
     }
 
+    void DBClientConnection::_negotiateCompression() {
+        BSONObj info;
+        if ( ! runCommand( "admin" , BSON( "isMaster" << 1 << "compression" << BSON_ARRAY( "lz" ) ) , info ) )
+            return;
+
+        BSONElement e = info["compression"];
+        if ( e.type() == String && strcmp( e.valuestr() , "lz" ) == 0 )
+            p->setCompressor( LZCompressor );
+    }
+
     void DBClientConnection::_checkConnection() {
         if ( !failed )
             return;
@@ -636,8 +660,7 @@ namespace mongo {
             /* connection CANNOT be used anymore as more data may be on the way from the server.
                we have to reconnect.
                */
-            failed = true;
-            p->shutdown();
+            exhaustAbandoned();
             throw;
         }
 
@@ -887,6 +910,11 @@ namespace mongo {
         }
     }
 
+    void DBClientConnection::exhaustAbandoned() {
+        failed = true;
+        p->shutdown();
+    }
+
     void DBClientConnection::killCursor( long long cursorId ){
         BufBuilder b;
         b.appendNum( (int)0 ); // reserved
@@ -900,6 +928,7 @@ namespace mongo {
     }
 
     AtomicUInt DBClientConnection::_numConnections;
+    bool DBClientConnection::_compressionDefault = false;
 
     /* --- class dbclientpaired --- */
 
@@ -69,8 +69,15 @@ namespace mongo {
             method, and it will take care of all the details for you.
         */
         QueryOption_Exhaust = 1 << 6,
+
+        /** For a query with a negative limit (one batch, no cursor) of whole documents, have the server write 
+            the reply straight from its data files rather than copying the documents into it first.  Saves cpu 
+            on big documents such as GridFS chunks.  The reply is the same either way; the server ignores 
+            the option when it can't (fields selected, explain, a sort no index gives, compression, ...).
+        */
+        QueryOption_DirectSend = 1 << 7,
         
-        QueryOption_AllSupported = QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay | QueryOption_NoCursorTimeout | QueryOption_AwaitData | QueryOption_Exhaust
+        QueryOption_AllSupported = QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay | QueryOption_NoCursorTimeout | QueryOption_AwaitData | QueryOption_Exhaust | QueryOption_DirectSend
 
     };
 
@@ -334,6 +341,13 @@ namespace mongo {
 
         /* used by QueryOption_Exhaust.  To use that your subclass must implement this. */
         virtual void recv( Message& m ) { assert(false); }
+
+        /* true if recv() is implemented, so cursors may stream with QueryOption_Exhaust */
+        virtual bool exhaustCapable() const { return false; }
+
+        /* an exhaust cursor was abandoned before the end of its stream.  replies are still 
+           on the way, so nothing else can be sent or received on this connection. */
+        virtual void exhaustAbandoned() { }
     };
 
     /**
@@ -804,6 +818,8 @@ namespace mongo {
 
            @param serverHostname host to connect to.  can include port number ( 127.0.0.1 , 127.0.0.1:5555 )
                                  If you use IPv6 you must add a port number ( ::1:27017 )
+                                 A unix socket is given by its path ( /tmp/mongodb-27017.sock ), or on
+                                 linux by @name for one in the abstract namespace
            @param errmsg any relevant error message will appended to the string
            @deprecated please use HostAndPort
            @return false if fails to connect.
@@ -883,12 +899,21 @@ namespace mongo {
         virtual ConnectionString::ConnectionType type() const { return ConnectionString::MASTER; }  
         virtual bool isMember( const DBConnector * conn ) const { return this == conn; };
         virtual void checkResponse( const char *data, int nReturned );
+        virtual bool exhaustCapable() const { return true; }
+        virtual void exhaustAbandoned();
         void setSoTimeout(double to) { _so_timeout = to; }
         
         static int getNumConnections(){
             return _numConnections;
         }
 
+        /** offer the server compression (see negotiateCompression) when connections made from now on
+            connect.  servers which don't know about it leave the connection as it is.
+        */
+        static void setCompressionDefault( bool on ){
+            _compressionDefault = on;
+        }
+
     protected:
         friend class SyncClusterConnection;
         virtual void recv( Message& m );
@@ -910,8 +935,10 @@ namespace mongo {
         map< string, pair<string,string> > authCache;
         double _so_timeout;        
         bool _connect( string& errmsg );
+        void _negotiateCompression();
 
         static AtomicUInt _numConnections;
+        static bool _compressionDefault;
     };
     
     /** Use this class to connect to a replica set of servers.  The class will manage
@@ -38,6 +38,8 @@ namespace mongo {
     }
 
     bool DBClientCursor::init() {
+        if ( ! connector->exhaustCapable() )
+            opts &= ~QueryOption_Exhaust;
         Message toSend;
         if ( !cursorId ) {
             assembleRequest( ns, query, nextBatchSize() , nToSkip, fieldsToReturn, opts, toSend );
@@ -114,7 +116,11 @@ namespace mongo {
                 throw UserException( 13127 , "getMore: cursor didn't exist on server, possible restart or timeout?" );
         }
         
-        if ( cursorId == 0 || ! ( opts & QueryOption_CursorTailable ) ) {
+        if ( ( opts & QueryOption_Exhaust ) && qr->cursorId == 0 ) {
+            // end of the stream, even for a tailable cursor: the server won't send any more
+            cursorId = 0;
+        }
+        else if ( cursorId == 0 || ! ( opts & QueryOption_CursorTailable ) ) {
             // only set initially: we don't want to kill it on end of data
             // if it's a tailable cursor
             cursorId = qr->cursorId;
@@ -146,7 +152,10 @@ namespace mongo {
         if ( cursorId == 0 )
             return false;
 
-        requestMore();
+        if ( opts & QueryOption_Exhaust )
+            exhaustReceiveMore();
+        else
+            requestMore();
         return pos < nReturned;
     }
 
@@ -205,7 +214,12 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
-            if ( cursorId && _ownCursor ) {
+            if ( cursorId && _ownCursor && ( opts & QueryOption_Exhaust ) ) {
+                // the server only stops streaming at the end, so all we can do is hang up
+                if ( connector )
+                    connector->exhaustAbandoned();
+            }
+            else if ( cursorId && _ownCursor ) {
                 BufBuilder b;
                 b.appendNum( (int)0 ); // reserved
                 b.appendNum( (int)1 ); // number
@@ -138,6 +138,10 @@ namespace mongo {
                 pos(),
                 data(),
                 _ownCursor( true ){
+            if ( haveLimit ) {
+                // the server streams exhaust batches without looking at the limit
+                opts &= ~QueryOption_Exhaust;
+            }
         }
         
         DBClientCursor( DBConnector *_connector, const string &_ns, long long _cursorId, int _nToReturn, int options ) :
@@ -215,12 +215,26 @@ namespace mongo {
 
         const int num = getNumChunks();
 
-        for ( int i=0; i<num; i++ ){
-            GridFSChunk c = getChunk( i );
-
-            int len;
-            const char * data = c.data( len );
-            out.write( data , len );
+        /* as many chunks per round trip as fit in a reply, sent by the server straight from its data files */
+        int i = 0;
+        while ( i < num ){
+            BSONObjBuilder b;
+            b.appendAs( _obj["_id"] , "files_id" );
+            b.append( "n" , BSON( "$gte" << i ) );
+            auto_ptr<DBClientCursor> cursor = _grid->_client.query( _grid->_chunksNS.c_str() , Query( b.obj() ).sort( "n" ) ,
+                                                                     -( num - i ) , 0 , 0 , QueryOption_DirectSend );
+            uassert( 13625 , "couldn't read chunks" , cursor.get() );
+            uassert( 10014 ,  "chunk is empty!" , cursor->more() );
+            while ( cursor->more() ){
+                BSONObj o = cursor->nextSafe();
+                uassert( 10014 ,  "chunk is empty!" , o["n"].numberInt() == i );
+                GridFSChunk c( o );
+
+                int len;
+                const char * data = c.data( len );
+                out.write( data , len );
+                i++;
+            }
         }
 
         return getContentLength();
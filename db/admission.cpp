@@ -0,0 +1,251 @@
+// admission.cpp
+
+/*
+ *    Copyright (C) 2010 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include "admission.h"
+#include "jsobj.h"
+#include "commands.h"
+#include "client.h"
+#include "../util/timer.h"
+
+namespace mongo {
+
+    AdmissionControl admissionControl;
+
+    AdmissionControl::Queue::Queue()
+        : m("AdmissionControl") , limit(0) , running(0) , admitted(0) , waited(0) , waitMicros(0) {
+        for ( int i=0; i<NumPriorities; i++ )
+            next[i] = serving[i] = 0;
+    }
+
+    int AdmissionControl::Queue::queued() const {
+        unsigned long long n = 0;
+        for ( int i=0; i<NumPriorities; i++ )
+            n += next[i] - serving[i];
+        return (int)n;
+    }
+
+    bool AdmissionControl::Queue::canRun( int p , unsigned long long n ) const {
+        if ( limit > 0 && running >= limit )
+            return false;
+        if ( serving[p] != n )
+            return false;
+        for ( int i=p+1; i<NumPriorities; i++ )
+            if ( next[i] != serving[i] )
+                return false;
+        return true;
+    }
+
+    AdmissionControl::AdmissionControl() : _dbMutex("AdmissionControl::db") { }
+
+    AdmissionControl::Ticket::Ticket( AdmissionControl& ac , Kind k , Priority p )
+        : _ac(ac) , _kind(k) , _acquired( ac.acquire( k , p ) ) {
+    }
+
+    AdmissionControl::Ticket::~Ticket() {
+        if ( _acquired )
+            _ac.release( _kind );
+    }
+
+    bool AdmissionControl::acquire( Kind k , Priority p ) {
+        Queue& q = _queues[k];
+        scoped_lock lk( q.m );
+        if ( q.limit <= 0 ) {
+            /* not counted, so a limit set while this runs doesn't see it.
+               that only lets a few extra through once. */
+            return false;
+        }
+
+        unsigned long long n = q.next[p]++;
+        if ( ! q.canRun( p , n ) ) {
+            Timer t;
+            while ( ! q.canRun( p , n ) )
+                q.c.wait( lk.boost() );
+            q.waited++;
+            q.waitMicros += t.micros();
+        }
+
+        q.serving[p]++;
+        q.running++;
+        q.admitted++;
+        /* the next in line, possibly of lower priority, may be able to go too */
+        q.c.notify_all();
+        return true;
+    }
+
+    void AdmissionControl::release( Kind k ) {
+        Queue& q = _queues[k];
+        scoped_lock lk( q.m );
+        q.running--;
+        q.c.notify_all();
+    }
+
+    void AdmissionControl::setLimit( Kind k , int limit ) {
+        Queue& q = _queues[k];
+        scoped_lock lk( q.m );
+        q.limit = limit < 0 ? 0 : limit;
+        q.c.notify_all();
+    }
+
+    int AdmissionControl::getLimit( Kind k ) {
+        Queue& q = _queues[k];
+        scoped_lock lk( q.m );
+        return q.limit;
+    }
+
+    int AdmissionControl::queued( Kind k ) {
+        Queue& q = _queues[k];
+        scoped_lock lk( q.m );
+        return q.queued();
+    }
+
+    void AdmissionControl::setDBPriority( const string& db , Priority p ) {
+        scoped_lock lk( _dbMutex );
+        if ( p == Normal )
+            _dbPriorities.erase( db );
+        else
+            _dbPriorities[db] = p;
+    }
+
+    AdmissionControl::Priority AdmissionControl::getDBPriority( const string& db ) {
+        scoped_lock lk( _dbMutex );
+        map<string,Priority>::const_iterator i = _dbPriorities.find( db );
+        if ( i == _dbPriorities.end() )
+            return Normal;
+        return i->second;
+    }
+
+    void AdmissionControl::append( BSONObjBuilder& b ) {
+        for ( int k=0; k<NumKinds; k++ ) {
+            Queue& q = _queues[k];
+            BSONObjBuilder bb( b.subobjStart( kindToString( (Kind)k ) ) );
+            {
+                scoped_lock lk( q.m );
+                bb.append( "limit" , q.limit );
+                bb.append( "running" , q.running );
+                bb.append( "queued" , q.queued() );
+                bb.appendNumber( "admitted" , q.admitted );
+                bb.appendNumber( "waited" , q.waited );
+                bb.appendNumber( "waitMicros" , q.waitMicros );
+            }
+            bb.done();
+        }
+
+        BSONObjBuilder bb( b.subobjStart( "dbPriorities" ) );
+        {
+            scoped_lock lk( _dbMutex );
+            for ( map<string,Priority>::const_iterator i = _dbPriorities.begin(); i != _dbPriorities.end(); ++i )
+                bb.append( i->first , priorityToString( i->second ) );
+        }
+        bb.done();
+    }
+
+    const char * AdmissionControl::kindToString( Kind k ) {
+        switch ( k ) {
+        case Read: return "reads";
+        case Write: return "writes";
+        case Cmd: return "commands";
+        default: return "?";
+        }
+    }
+
+    const char * AdmissionControl::priorityToString( Priority p ) {
+        switch ( p ) {
+        case Low: return "low";
+        case Normal: return "normal";
+        case High: return "high";
+        default: return "?";
+        }
+    }
+
+    int AdmissionControl::priorityFromString( const string& s ) {
+        for ( int p=0; p<NumPriorities; p++ )
+            if ( s == priorityToString( (Priority)p ) )
+                return p;
+        return -1;
+    }
+
+    /* { admissionControl : 1 [, reads : <n>] [, writes : <n>] [, commands : <n>] [, db : <name> , priority : <p>] } */
+    class CmdAdmissionControl : public Command {
+    public:
+        CmdAdmissionControl() : Command( "admissionControl" ) { }
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "set request concurrency limits and database priorities; 0 means no limit\n"
+                 << "{ admissionControl : 1 , reads : <n> , writes : <n> , commands : <n> }\n"
+                 << "{ admissionControl : 1 , db : <name> , priority : 'low'|'normal'|'high' }";
+        }
+        bool run(const string& dbname, BSONObj& cmdObj, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
+            for ( int k=0; k<AdmissionControl::NumKinds; k++ ) {
+                BSONElement e = cmdObj[ AdmissionControl::kindToString( (AdmissionControl::Kind)k ) ];
+                if ( e.eoo() )
+                    continue;
+                if ( ! e.isNumber() || e.numberInt() < 0 ) {
+                    errmsg = string( e.fieldName() ) + " must be a non-negative number";
+                    return false;
+                }
+                admissionControl.setLimit( (AdmissionControl::Kind)k , e.numberInt() );
+            }
+
+            BSONElement db = cmdObj["db"];
+            if ( ! db.eoo() ) {
+                int p = AdmissionControl::priorityFromString( cmdObj["priority"].str() );
+                if ( db.type() != String || p < 0 ) {
+                    errmsg = "db needs a name and priority one of low, normal or high";
+                    return false;
+                }
+                admissionControl.setDBPriority( db.str() , (AdmissionControl::Priority)p );
+            }
+
+            admissionControl.append( result );
+            return true;
+        }
+    } cmdAdmissionControl;
+
+    /* { setPriority : 'low'|'normal'|'high'|'default' } - for the rest of this connection */
+    class CmdSetPriority : public Command {
+    public:
+        CmdSetPriority() : Command( "setPriority" ) { }
+        virtual bool slaveOk() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "set the admission priority of this connection's requests\n"
+                 << "{ setPriority : 'low'|'normal'|'high'|'default' }  high requires admin";
+        }
+        bool run(const string& dbname, BSONObj& cmdObj, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
+            Client& c = cc();
+            string s = cmdObj.firstElement().str();
+            int p = s == "default" ? -1 : AdmissionControl::priorityFromString( s );
+            if ( p < 0 && s != "default" ) {
+                errmsg = "priority must be one of low, normal, high or default";
+                return false;
+            }
+            if ( p == AdmissionControl::High && ! c.isAdmin() ) {
+                errmsg = "high priority requires admin";
+                return false;
+            }
+            int was = c.getPriority();
+            c.setPriority( p );
+            result.append( "was" , was < 0 ? "default" : AdmissionControl::priorityToString( (AdmissionControl::Priority)was ) );
+            return true;
+        }
+    } cmdSetPriority;
+
+} // namespace mongo
@@ -0,0 +1,102 @@
+// admission.h
+
+/*
+ *    Copyright (C) 2010 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "../pch.h"
+#include "../util/concurrency/mutex.h"
+#include <boost/thread/condition.hpp>
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * request admission control, applied in assembleResponse.
+     * reads, writes and commands each have their own concurrency limit and queue.
+     * requests over the limit wait: highest priority first, fifo within a priority.
+     * a limit of 0 means unlimited, which is the default.
+     */
+    class AdmissionControl : boost::noncopyable {
+    public:
+        enum Kind { Read = 0 , Write = 1 , Cmd = 2 , NumKinds = 3 };
+        enum Priority { Low = 0 , Normal = 1 , High = 2 , NumPriorities = 3 };
+
+        /** holds a slot of the given kind until destroyed */
+        class Ticket : boost::noncopyable {
+        public:
+            Ticket( AdmissionControl& ac , Kind k , Priority p );
+            ~Ticket();
+        private:
+            AdmissionControl& _ac;
+            Kind _kind;
+            bool _acquired;
+        };
+
+        AdmissionControl();
+
+        /** racy read, only used to skip all of this when there is no limit */
+        bool limited( Kind k ) const { return _queues[k].limit > 0; }
+
+        void setLimit( Kind k , int limit );
+        int getLimit( Kind k );
+
+        /** number of requests of kind k waiting for a slot */
+        int queued( Kind k );
+
+        void setDBPriority( const string& db , Priority p );
+        /** @return priority set for db, Normal if none */
+        Priority getDBPriority( const string& db );
+
+        void append( BSONObjBuilder& b );
+
+        static const char * kindToString( Kind k );
+        static const char * priorityToString( Priority p );
+        /** @return -1 if s isn't a priority name */
+        static int priorityFromString( const string& s );
+
+    private:
+        bool acquire( Kind k , Priority p );
+        void release( Kind k );
+
+        struct Queue {
+            Queue();
+            mongo::mutex m;
+            boost::condition c;
+            int limit;
+            int running;
+            /* per priority: tickets handed out, and how many of those were admitted */
+            unsigned long long next[NumPriorities];
+            unsigned long long serving[NumPriorities];
+            long long admitted;
+            long long waited;
+            long long waitMicros;
+
+            int queued() const;
+            /* true if ticket n of priority p may run now */
+            bool canRun( int p , unsigned long long n ) const;
+        };
+
+        Queue _queues[NumKinds];
+        mongo::mutex _dbMutex;
+        map<string,Priority> _dbPriorities;
+    };
+
+    extern AdmissionControl admissionControl;
+
+} // namespace mongo
@@ -1096,6 +1096,46 @@ namespace mongo {
         return false;
     }
 
+    /** @return <0, 0, >0 comparing key:recordLoc pairs the way the btree orders its entries */
+    static int compareKeyLoc(const BSONObj& l, DiskLoc lLoc, const BSONObj& r, DiskLoc rLoc, const Ordering &order) {
+        int x = l.woCompare(r, order);
+        if ( x )
+            return x;
+        lLoc.GETOFS() &= ~1;
+        rLoc.GETOFS() &= ~1;
+        return lLoc.compare(rLoc);
+    }
+
+    bool BtreeBucket::relocate(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc oldLoc, const DiskLoc newLoc) const {
+        if ( key.objsize() > KeyMax )
+            return false;
+
+        Ordering order = Ordering::make(id.keyPattern());
+        int pos;
+        bool found;
+        DiskLoc loc = locate(id, thisLoc, key, order, pos, found, oldLoc, 1);
+        if ( !found )
+            return false;
+
+        /* entries are ordered by key and then recordLoc, so the entry can only be rewritten where it
+           stands if its neighbors still bracket newLoc.  we only look at neighbors in this bucket with
+           no children in between; anything else is left to the caller's unindex + insert.
+        */
+        const BtreeBucket *b = loc.btree();
+        if ( b->k(pos).isUnused() || pos == 0 || pos + 1 >= b->n )
+            return false;
+        if ( !b->k(pos).prevChildBucket.isNull() || !b->k(pos+1).prevChildBucket.isNull() )
+            return false;
+        KeyNode before = b->keyNode(pos-1);
+        KeyNode after = b->keyNode(pos+1);
+        if ( compareKeyLoc(before.key, before.recordLoc, key, newLoc, order) >= 0 ||
+             compareKeyLoc(key, newLoc, after.key, after.recordLoc, order) >= 0 )
+            return false;
+
+        b->k(pos).writing().recordLoc = newLoc;
+        return true;
+    }
+
     BtreeBucket* BtreeBucket::allocTemp() {
         BtreeBucket *b = (BtreeBucket*) malloc(BucketSize);
         b->init();
@@ -315,6 +315,12 @@ namespace mongo {
         /** This function may change the btree root */
         bool unindex(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc recordLoc) const;
 
+        /**
+         * Point the key:oldLoc entry at newLoc without moving it, when that keeps the btree ordered.
+         * @return false if the entry was not rewritten; the caller should unindex and insert instead.
+         */
+        bool relocate(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc oldLoc, const DiskLoc newLoc) const;
+
         /**
          * locate may return an "unused" key that is just a marker.  so be careful.
          *   looks for a key:recordloc pair.
@@ -46,6 +46,7 @@ namespace mongo {
       _desc(desc),
       _god(0),
       _lastOp(0), 
+      _priority(-1),
       _mp(p)
     {
         _curOp = new CurOp( this );
@@ -170,6 +170,7 @@ namespace mongo {
         ReplTime _lastOp;
         BSONObj _handshake;
         BSONObj _remoteId;
+        int _priority;
 
     public:
         MessagingPort * const _mp;
@@ -190,6 +191,11 @@ namespace mongo {
         void setLastOp( ReplTime op ) { _lastOp = op; }
         ReplTime getLastOp() const { return _lastOp; }
 
+        /* admission priority for this connection's requests, see admission.h.
+           -1 means use the database's. */
+        int getPriority() const { return _priority; }
+        void setPriority( int p ) { _priority = p; }
+
         static void invalidateDB(const string& db);
         static void invalidateNS( const string& ns );
 
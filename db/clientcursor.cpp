@@ -243,6 +243,37 @@ namespace mongo {
     }
     void aboutToDelete(const DiskLoc& dl) { ClientCursor::aboutToDelete(dl); }
 
+    ReplyBatchSizer::ReplyBatchSizer() : 
+        _objs(0), _bytes(0), _lastSent(0), _batchBytes( MaxBytesToReturnToClientAtOnce ) {
+    }
+
+    int ReplyBatchSizer::nextBatchBytes() {
+        if ( _lastSent ) {
+            unsigned long long gap = curTimeMicros64() - _lastSent;
+            if ( gap < FastClientMicros )
+                _batchBytes = min( _batchBytes * 2 , MaxBytesToReturnToClientAtOnce );
+            else if ( gap > SlowClientMicros )
+                _batchBytes = max( _batchBytes / 2 , (int) MinBytes );
+        }
+        return _batchBytes;
+    }
+
+    int ReplyBatchSizer::bufferHint( int ntoreturn ) const {
+        int avg = avgObjSize();
+        if ( avg == 0 )
+            return _batchBytes;
+        int len = _batchBytes;
+        if ( ntoreturn > 0 && ntoreturn < len / avg )
+            len = ntoreturn * avg;
+        return len + avg; // the object that goes over
+    }
+
+    void ReplyBatchSizer::sent( int n , int len ) {
+        _objs += n;
+        _bytes += len;
+        _lastSent = curTimeMicros64();
+    }
+
     ClientCursor::ClientCursor(int queryOptions, const shared_ptr<Cursor>& c, const string& ns, BSONObj query ) :
         _ns(ns), _db( cc().database() ),
         _c(c), _pos(0), 
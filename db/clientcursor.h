@@ -69,6 +69,43 @@ namespace mongo {
 
     extern BSONObj id_obj;
 
+    /**
+     * sizes the getMore replies of one cursor from what it has seen so far.
+     * the byte budget halves while the client is slow to come back for more (it isn't waiting 
+     * on us, so big replies would only sit in memory) and doubles while it comes straight back
+     * (then round trips are what it waits on), between MinBytes and MaxBytesToReturnToClientAtOnce.
+     * building a reply also stops after BuildMicros, so expensive documents don't make latency spikes.
+     */
+    class ReplyBatchSizer {
+    public:
+        enum {
+            MinBytes = 64 * 1024,
+            FastClientMicros = 10 * 1000,  // asked for more within this: grow
+            SlowClientMicros = 500 * 1000, // took longer than this: shrink
+            BuildMicros = 50 * 1000        // time budget for building one reply
+        };
+
+        ReplyBatchSizer();
+
+        /** call as a getMore arrives. @return byte budget for its reply */
+        int nextBatchBytes();
+        int batchBytes() const { return _batchBytes; }
+
+        /** how much to reserve for a reply of at most ntoreturn objects (0 for no limit) */
+        int bufferHint( int ntoreturn ) const;
+
+        /** a reply of n objects, len bytes, was built */
+        void sent( int n , int len );
+
+        int avgObjSize() const { return _objs ? (int)( _bytes / _objs ) : 0; }
+
+    private:
+        long long _objs;
+        long long _bytes;
+        unsigned long long _lastSent; // curTimeMicros64() when the last reply was built
+        int _batchBytes;
+    };
+
     class ClientCursor {
         friend class CmdCursorInfo;
     public:
@@ -360,6 +397,7 @@ namespace mongo {
         shared_ptr<ParsedQuery> pq;
         shared_ptr<Projection> fields; // which fields query wants returned
         Message originalMessage; // this is effectively an auto ptr for data the matcher points to
+        ReplyBatchSizer batchSizer;
 
 
 
@@ -20,6 +20,7 @@
 #include "cmdline.h"
 #include "commands.h"
 #include "../util/processinfo.h"
+#include "../client/dbclient.h"
 
 namespace po = boost::program_options;
 
@@ -43,10 +44,12 @@ namespace mongo {
             ("verbose,v", "be more verbose (include multiple times for more verbosity e.g. -vvvvv)")
             ("quiet", "quieter output")
             ("port", po::value<int>(&cmdLine.port), "specify port number")
-            ("bind_ip", po::value<string>(&cmdLine.bind_ip), "comma separated list of ip addresses to listen on - all local ips by default")
+            ("bind_ip", po::value<string>(&cmdLine.bind_ip), "comma separated list of ip addresses to listen on - all local ips by default.  a /path, or on linux @name, is a unix socket")
             ("logpath", po::value<string>() , "log file to send write to instead of stdout - has to be a file, not directory" )
             ("logappend" , "append to logpath instead of over-writing" )
             ("pidfilepath", po::value<string>(), "full path to pidfile (if not set, no pidfile is created)")
+            ("acceptThreads", po::value<int>(&cmdLine.acceptThreads), "accept connections on this many threads, using SO_REUSEPORT")
+            ("networkCompression", "compress traffic to other servers (replication, sharding) that can take it")
 #ifndef _WIN32
             ("fork" , "fork server process" )
 #endif
@@ -144,6 +147,15 @@ namespace mongo {
             cmdLine.quiet = true;
         }
 
+        if (cmdLine.acceptThreads < 1) {
+            cout << "error command line: acceptThreads has to be at least 1" << endl;
+            return false;
+        }
+
+        if (params.count("networkCompression")) {
+            DBClientConnection::setCompressionDefault( true );
+        }
+
         string logpath;
 
 #ifndef _WIN32
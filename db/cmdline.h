@@ -27,8 +27,8 @@ namespace mongo {
     struct CmdLine { 
         CmdLine() : 
             port(DefaultDBPort), rest(false), jsonp(false), quiet(false), noTableScan(false), prealloc(true), smallfiles(false),
-            quota(false), quotaFiles(8), cpu(false), durTrace(0), oplogSize(0), defaultProfile(0), slowMS(100), pretouch(0), moveParanoia( true ), 
-            syncdelay(60)
+            quota(false), quotaFiles(8), cpu(false), durTrace(0), oplogSize(0), defaultProfile(0), slowMS(100), pretouch(0), parallelScan(0), moveParanoia( true ), 
+            syncdelay(60), acceptThreads(1)
         { 
             // default may change for this later.
             dur = false;
@@ -88,8 +88,10 @@ namespace mongo {
         int slowMS;            // --time in ms that is "slow"
 
         int pretouch;          // --pretouch for replication application (experimental)
+        int parallelScan;      // --parallelScan n threads for unindexed count (experimental)
         bool moveParanoia;     // for move chunk paranoia 
         double syncdelay;      // seconds between fsyncs
+        int acceptThreads;     // --acceptThreads threads accepting connections (SO_REUSEPORT)
 
         static void addGlobalOptions( boost::program_options::options_description& general , 
                                       boost::program_options::options_description& hidden );
@@ -40,28 +40,39 @@ namespace mongo {
      * stores a copy of a bson obj in a fixed size buffer
      * if its too big for the buffer, says "too big"
      * useful for keeping a copy around indefinitely without wasting a lot of space or doing malloc
+     * an owned obj (such as a query from a received message) is just referenced, and only copied
+     * when someone asks for it -- usually currentOp, which is rare next to the ops setting it.
      */
     class CachedBSONObj {
     public:
-        enum { TOO_BIG_SENTINEL = 1 } ;
+        enum { TOO_BIG_SENTINEL = 1 , OWNED_SENTINEL = 2 } ;
         static BSONObj _tooBig; // { $msg : "query not recording (too large)" }
 
         CachedBSONObj(){
             _size = (int*)_buf;
-            reset();
+            _reset();
         }
         
-        void reset( int sz = 0 ) { _size[0] = sz; }
+        void reset( int sz = 0 ) {
+            _lock.lock();
+            _reset( sz );
+            _lock.unlock();
+        }
         
         void set( const BSONObj& o ){
             _lock.lock();
             try {
                 int sz = o.objsize();
                 
-                if ( sz > (int) sizeof(_buf) ) { 
-                    reset(TOO_BIG_SENTINEL);
+                if ( o.isOwned() ) {
+                    _owned = o;
+                    _size[0] = OWNED_SENTINEL;
+                }
+                else if ( sz > (int) sizeof(_buf) ) { 
+                    _reset(TOO_BIG_SENTINEL);
                 }
                 else {
+                    _owned = BSONObj();
                     memcpy(_buf, o.objdata(), sz );
                 }
                 
@@ -105,6 +116,12 @@ namespace mongo {
         }
         
     private:
+        /** you have to be locked when you call this */
+        void _reset( int sz = 0 ) {
+            _size[0] = sz;
+            _owned = BSONObj();
+        }
+
         /** you have to be locked when you call this */
         BSONObj _get(){
             int sz = size();
@@ -112,12 +129,19 @@ namespace mongo {
                 return BSONObj();
             if ( sz == TOO_BIG_SENTINEL )
                 return _tooBig;
+            if ( sz == OWNED_SENTINEL ) {
+                // the same limit as for a copy, so what's reported doesn't depend on where the obj came from
+                if ( _owned.objsize() > (int) sizeof(_buf) )
+                    return _tooBig;
+                return _owned;
+            }
             return BSONObj( _buf ).copy();
         }
 
         SpinLock _lock;
         int * _size;
         char _buf[512];
+        BSONObj _owned;
     };
 
     /* Current operation (for the current Client).
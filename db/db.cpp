@@ -168,6 +168,7 @@ namespace mongo {
         log() << "waiting for connections on port " << port << endl;
         OurListener l(cmdLine.bind_ip, port);
         l.setAsTimeTracker();
+        l.setAcceptThreads(cmdLine.acceptThreads);
         startReplication();
         if ( !noHttpInterface )
             boost::thread web( boost::bind(&webServerThread, new RestAdminAccess() /* takes ownership */));
@@ -211,6 +212,7 @@ namespace mongo {
         inPort->_logLevel = 1;
         auto_ptr<MessagingPort> dbMsgPort( inPort );
         Client& c = Client::initThread("conn", inPort);
+        long long exhaustCursorId = 0; // cursor we are streaming to the client, if any
 
         try {
 
@@ -250,12 +252,21 @@ sendmore:
                 }
 
                 if ( dbresponse.response ) {
-                    dbMsgPort->reply(m, *dbresponse.response, dbresponse.responseTo);
+                    if( dbresponse.exhaust ) {
+                        /* a stream of replies follows; holding one back for piggybacking would stall it */
+                        dbMsgPort->say(*dbresponse.response, dbresponse.responseTo);
+                    }
+                    else {
+                        dbMsgPort->reply(m, *dbresponse.response, dbresponse.responseTo);
+                    }
+                    exhaustCursorId = 0;
                     if( dbresponse.exhaust ) { 
                         MsgData *header = dbresponse.response->header();
                         QueryResult *qr = (QueryResult *) header;
                         long long cursorid = qr->cursorId;
                         if( cursorid ) {
+                            /* the socket paces us: say() blocks while the client is behind */
+                            exhaustCursorId = cursorid;
                             assert( dbresponse.exhaust && *dbresponse.exhaust != 0 );
                             string ns = dbresponse.exhaust; // before reset() free's it...
                             m.reset();
@@ -291,6 +302,10 @@ sendmore:
         catch ( SocketException& ) {
             problem() << "SocketException in connThread, closing client connection" << endl;
             dbMsgPort->shutdown();
+            if( exhaustCursorId ) {
+                /* the client went away mid stream, no one will ever kill this cursor */
+                ClientCursor::erase( exhaustCursorId );
+            }
         }
         catch ( const ClockSkewException & ) {
             exitCleanly( EXIT_CLOCK_SKEW );
@@ -744,6 +759,7 @@ int main(int argc, char* argv[])
 
     hidden_options.add_options()
         ("pretouch", po::value<int>(), "n pretouch threads for applying replicationed operations")
+        ("parallelScan", po::value<int>(), "n threads for counting over unindexed collection scans")
         ("command", po::value< vector<string> >(), "command")
         ("cacheSize", po::value<long>(), "cache size (in MB) for rec store")
         // these move to unhidden later:
@@ -929,6 +945,9 @@ int main(int argc, char* argv[])
         if( params.count("pretouch") ) { 
             cmdLine.pretouch = params["pretouch"].as<int>();
         }
+        if( params.count("parallelScan") ) { 
+            cmdLine.parallelScan = params["parallelScan"].as<int>();
+        }
         if (params.count("replSet")) {
             if (params.count("slavedelay")) {
                 out() << "--slavedelay cannot be used with --replSet" << endl;
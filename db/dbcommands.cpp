@@ -39,6 +39,7 @@
 #include "../scripting/engine.h"
 #include "stats/counters.h"
 #include "background.h"
+#include "admission.h"
 #include "../util/version.h"
 #include "../s/d_writeback.h"
 
@@ -416,6 +417,12 @@ namespace mongo {
                 bb.done();
             }
 
+            {
+                BSONObjBuilder bb( result.subobjStart( "admission" ) );
+                admissionControl.append( bb );
+                bb.done();
+            }
+
             
             timeBuilder.appendNumber( "after counters" , Listener::getElapsedTimeMillis() - start );            
 
@@ -82,6 +82,7 @@ namespace mongo {
             help << "{ getParameter:1, notablescan:1 }\n";
             help << "supported so far:\n";
             help << "  quiet\n";
+            help << "  parallelScan\n";
             help << "  notablescan\n";
             help << "  logLevel\n";
             help << "  syncdelay\n";
@@ -104,6 +105,9 @@ namespace mongo {
             if( all || cmdObj.hasElement("syncdelay") ) {
                 result.append("syncdelay", cmdLine.syncdelay);
             }
+            if( all || cmdObj.hasElement("parallelScan") ) {
+                result.append("parallelScan", cmdLine.parallelScan);
+            }
             if( all || cmdObj.hasElement("replApplyBatchSize") ) {
                 result.append("replApplyBatchSize", replApplyBatchSize);
             }           
@@ -129,6 +133,7 @@ namespace mongo {
             help << "  notablescan\n";
             help << "  logLevel\n";
             help << "  quiet\n";
+            help << "  parallelScan\n";
         }
         bool run(const string& dbname, BSONObj& cmdObj, string& errmsg, BSONObjBuilder& result, bool fromRepl ){
             int s = 0;
@@ -147,6 +152,11 @@ namespace mongo {
                 cmdLine.syncdelay = cmdObj["syncdelay"].Number();
                 s++;
             }
+            if( cmdObj.hasElement( "parallelScan" ) ) {
+                result.append("was", cmdLine.parallelScan );
+                cmdLine.parallelScan = cmdObj["parallelScan"].numberInt();
+                s++;
+            }
             if( cmdObj.hasElement( "logLevel" ) ) {
                 result.append("was", logLevel );
                 logLevel = cmdObj["logLevel"].numberInt();
@@ -137,7 +137,7 @@ namespace mongo {
                 massert( 13066 ,  "Message contains no documents", theEnd > nextjsobj );
             }
             massert( 10304 ,  "Client Error: Remaining data too small for BSON object", theEnd - nextjsobj > 3 );
-            BSONObj js(nextjsobj);
+            BSONObj js = _bufHolder ? BSONObj( nextjsobj, _bufHolder ) : BSONObj( nextjsobj );
             massert( 10305 ,  "Client Error: Invalid object size", js.objsize() > 3 );
             massert( 10306 ,  "Client Error: Next object larger than space left in message",
                     js.objsize() < ( theEnd - data ) );
@@ -150,6 +150,19 @@ namespace mongo {
             return js;
         }
 
+        /** objects from nextJsObj() from now on share ownership of the message buffer instead of pointing
+            into it unowned, so holding on to them -- or calling getOwned() -- copies nothing.  they keep
+            the whole message allocated, so this is for small messages like queries.  does nothing unless
+            the message owns a single buffer.
+        */
+        void shareBuffer() {
+            if ( _bufHolder || !m.canShareData() )
+                return;
+            if ( !m.sharedData() )
+                m.shareData( boost::shared_ptr<void>( new BSONObj::Holder( (const char *) m.singleData() ) ) );
+            _bufHolder = boost::static_pointer_cast< BSONObj::Holder >( m.sharedData() );
+        }
+
         const Message& msg() const { return m; }
 
         void markSet(){
@@ -168,6 +181,8 @@ namespace mongo {
         const char *theEnd;
 
         const char * mark;
+
+        boost::shared_ptr< BSONObj::Holder > _bufHolder;
     };
 
 
@@ -186,6 +201,7 @@ namespace mongo {
             ns = d.getns();
             ntoskip = d.pullInt();
             ntoreturn = d.pullInt();
+            d.shareBuffer();
             query = d.nextJsObj();
             if ( d.moreJSObjs() ) {
                 fields = d.nextJsObj();
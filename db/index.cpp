@@ -143,6 +143,59 @@ namespace mongo {
         }
     }
 
+    namespace {
+        /** orders key:recordLoc pairs the way the btree holds them */
+        class KeyLocLess {
+        public:
+            KeyLocLess(const Ordering& o) : _o(o) { }
+            bool operator()(const pair<BSONObj, DiskLoc>& l, const pair<BSONObj, DiskLoc>& r) const {
+                int x = l.first.woCompare(r.first, _o);
+                if ( x )
+                    return x < 0;
+                return l.second < r.second;
+            }
+        private:
+            Ordering _o;
+        };
+    }
+
+    IndexUpdateBatch::~IndexUpdateBatch() {
+        if ( empty() )
+            return;
+        try {
+            apply();
+        }
+        catch (...) {
+            problem() << "couldn't apply batched index changes" << endl;
+        }
+    }
+
+    void IndexUpdateBatch::apply() {
+        for ( int pass = 0; pass < 2; pass++ ) {
+            Pending& p = pass == 0 ? _removed : _added;
+            for ( Pending::iterator i = p.begin(); i != p.end(); i++ ) {
+                IndexDetails& idx = _d->idx(i->first);
+                Ordering ordering = Ordering::make(idx.keyPattern());
+                vector<KeyLoc>& keys = i->second;
+                sort(keys.begin(), keys.end(), KeyLocLess(ordering));
+                for ( vector<KeyLoc>::iterator k = keys.begin(); k != keys.end(); k++ ) {
+                    try {
+                        if ( pass == 0 )
+                            idx.head.btree()->unindex(idx.head, idx, k->first, k->second);
+                        else
+                            idx.head.btree()->bt_insert(idx.head, k->second, k->first, ordering, /*dupsAllowed*/true, idx);
+                    }
+                    catch (AssertionException& e) {
+                        problem() << " caught assertion batched update " << ( pass == 0 ? "unindex " : "index " )
+                                  << idx.indexNamespace() << " " << e << endl;
+                    }
+                }
+            }
+            p.clear();
+        }
+        _n = 0;
+    }
+
     void dupCheck(vector<IndexChanges>& v, NamespaceDetails& d, DiskLoc curObjLoc) {
         int z = d.nIndexesBeingBuilt();
         for( int i = 0; i < z; i++ ) {
@@ -170,6 +170,41 @@ namespace mongo {
     };
 
     class NamespaceDetails;
+
+    /**
+     * Index key changes from several records, held back so that a multi-update or a bulk insert can
+     * apply them an index at a time and in key order rather than one record at a time.  Never used
+     * for unique indexes -- dup checks need their keys in place -- nor for records that may be
+     * deleted or moved before the batch is applied.  Anything still pending is applied on destruction.
+     */
+    class IndexUpdateBatch : boost::noncopyable {
+    public:
+        enum { MaxKeys = 10000 };
+
+        IndexUpdateBatch(NamespaceDetails *d) : _d(d), _n(0) { }
+        ~IndexUpdateBatch();
+
+        void unindex(int idxNo, const BSONObj& key, const DiskLoc& loc) { add(_removed, idxNo, key, loc); }
+        void index(int idxNo, const BSONObj& key, const DiskLoc& loc) { add(_added, idxNo, key, loc); }
+
+        bool empty() const { return _n == 0; }
+        bool full() const { return _n >= MaxKeys; }
+
+        /** make the pending changes to the btrees; the caller must note and check any cursor position */
+        void apply();
+
+    private:
+        typedef pair<BSONObj, DiskLoc> KeyLoc;
+        typedef map<int, vector<KeyLoc> > Pending;
+        void add(Pending& p, int idxNo, const BSONObj& key, const DiskLoc& loc) {
+            p[idxNo].push_back( make_pair( key, loc ) );
+            _n++;
+        }
+        NamespaceDetails *_d;
+        Pending _removed, _added;
+        unsigned _n;
+    };
+
     // changedId should be initialized to false
     void getIndexChanges(vector<IndexChanges>& v, NamespaceDetails& d, BSONObj newObj, BSONObj oldObj, bool &cangedId);
     void dupCheck(vector<IndexChanges>& v, NamespaceDetails& d, DiskLoc curObjLoc);
@@ -37,6 +37,7 @@
 #endif
 #include "stats/counters.h"
 #include "background.h"
+#include "admission.h"
 #include "dur_journal.h"
 
 namespace mongo {
@@ -170,7 +171,10 @@ namespace mongo {
         
         try {
             dbresponse.exhaust = runQuery(m, q, op, *resp);
-            assert( !resp->empty() );
+            if ( resp->empty() ) {
+                /* runQuery wrote the reply to the socket itself (QueryOption_DirectSend) */
+                return ok;
+            }
         }
         catch ( AssertionException& e ) {
             ok = false;
@@ -216,8 +220,57 @@ namespace mongo {
         return ok;
     }
 
+    /* the BufBuilderPool for the request this thread is serving, if any.  never destroyed, so
+       builders freed during shutdown can still look it up. */
+    static ThreadLocalValue< BufBuilderPool* >& requestBufPool() {
+        static ThreadLocalValue< BufBuilderPool* > *p = new ThreadLocalValue< BufBuilderPool* >();
+        return *p;
+    }
+    static BufBuilderPool* currentRequestBufPool() { return requestBufPool().get(); }
+
+    /** lends the builders of one request a BufBuilderPool; nested requests (DBDirectClient) share the
+        outermost one.  the spare buffers are freed when the request is done. */
+    class RequestBufPoolScope : boost::noncopyable {
+    public:
+        RequestBufPoolScope() : _outer( requestBufPool().get() == 0 ) {
+            if ( _outer ) {
+                BufBuilderPool::setCurrentFn( currentRequestBufPool );
+                requestBufPool().set( &_pool );
+            }
+        }
+        ~RequestBufPoolScope() {
+            if ( _outer )
+                requestBufPool().set( 0 );
+        }
+    private:
+        bool _outer;
+        BufBuilderPool _pool;
+    };
+
+    /* which admission queue a request waits in, -1 for none.
+       admin and local are never queued so heartbeats, oplog tailing and the
+       admissionControl command itself still get through when things are backed up.
+    */
+    static int admissionKind( int op , bool isCommand , const char *ns ) {
+        int k;
+        if ( op == dbQuery )
+            k = isCommand ? AdmissionControl::Cmd : AdmissionControl::Read;
+        else if ( op == dbGetMore )
+            k = AdmissionControl::Read;
+        else if ( op == dbInsert || op == dbUpdate || op == dbDelete )
+            k = AdmissionControl::Write;
+        else
+            return -1;
+        if ( ! admissionControl.limited( (AdmissionControl::Kind)k ) )
+            return -1;
+        if ( strncmp( ns , "admin." , 6 ) == 0 || strncmp( ns , "local." , 6 ) == 0 )
+            return -1;
+        return k;
+    }
+
     // Returns false when request includes 'end'
     bool assembleResponse( Message &m, DbResponse &dbresponse, const SockAddr &client ) {
+        RequestBufPoolScope bufPool;
 
         // before we lock...
         int op = m.operation();
@@ -265,6 +318,16 @@ namespace mongo {
         }
         CurOp& currentOp = *currentOpP;
         currentOp.reset(client,op);
+
+        // nested requests (DBDirectClient) already hold their caller's slot
+        auto_ptr<AdmissionControl::Ticket> admission;
+        int kind = nestedOp.get() ? -1 : admissionKind( op , isCommand , ns );
+        if ( kind >= 0 ) {
+            int p = c.getPriority();
+            if ( p < 0 )
+                p = admissionControl.getDBPriority( nsToDatabase( ns ) );
+            admission.reset( new AdmissionControl::Ticket( admissionControl , (AdmissionControl::Kind)kind , (AdmissionControl::Priority)p ) );
+        }
         
         OpDebug& debug = currentOp.debug();
         StringBuilder& ss = debug.str;
@@ -575,6 +638,10 @@ namespace mongo {
             return;
 
         Client::Context ctx(ns);		
+
+        /* when a message carries several documents, their keys for non unique indexes are inserted
+           together, an index at a time and in key order, once the documents are in place */
+        auto_ptr<IndexUpdateBatch> batch;
         while ( d.moreJSObjs() ) {
             BSONObj js = d.nextJsObj();
             uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
@@ -587,10 +654,22 @@ namespace mongo {
                 }
             }
 
-            theDataFileMgr.insertWithObjMod(ns, js, false);
+            theDataFileMgr.insertWithObjMod(ns, js, false, batch.get());
             logOp("i", ns, js);
             globalOpCounters.gotInsert();
+
+            if ( batch.get() == 0 ) {
+                NamespaceDetails *nsd = nsdetails(ns);
+                if ( d.moreJSObjs() && nsd && nsd->nIndexes > 1 )
+                    batch.reset( new IndexUpdateBatch( nsd ) );
+            }
+            else if ( batch->full() ) {
+                batch->apply();
+            }
         }
+
+        if ( batch.get() )
+            batch->apply();
     }
 
     void getDatabaseNames( vector< string > &names , const string& usePath ) {
@@ -52,69 +52,121 @@ namespace mongo {
     MinKeyLabeler MINKEY;
     MaxKeyLabeler MAXKEY;
 
-    string escape( string s , bool escape_slash=false) {
-        StringBuilder ret;
-        for ( string::iterator i = s.begin(); i != s.end(); ++i ) {
-            switch ( *i ) {
-            case '"':
-                ret << "\\\"";
-                break;
-            case '\\':
-                ret << "\\\\";
-                break;
-            case '/':
-                ret << (escape_slash ? "\\/" : "/");
-                break;
-            case '\b':
-                ret << "\\b";
-                break;
-            case '\f':
-                ret << "\\f";
-                break;
-            case '\n':
-                ret << "\\n";
-                break;
-            case '\r':
-                ret << "\\r";
-                break;
-            case '\t':
-                ret << "\\t";
-                break;
-            default:
-                if ( *i >= 0 && *i <= 0x1f ) {
+    /* the json writers append to a caller's StringBuilder, so an object is formatted into one buffer
+       rather than through a stringstream and a string per element, and numbers and strings are
+       written without iostreams or sprintf where that's easy.
+    */
+    namespace {
+        const char hexchars[] = "0123456789abcdef";
+
+        /** append str[0..len) escaped for a json string, copying runs that need no escaping in one go */
+        void appendEscaped( StringBuilder& s, const char *str, int len, bool escape_slash = false ) {
+            const char *end = str + len;
+            const char *run = str;
+            for ( const char *p = str; p < end; ++p ) {
+                unsigned char c = *p;
+                if ( c > 0x1f && c != '"' && c != '\\' && !( c == '/' && escape_slash ) )
+                    continue;
+                s.write( run, (int) ( p - run ) );
+                run = p + 1;
+                switch ( c ) {
+                case '"': s.write( "\\\"", 2 ); break;
+                case '\\': s.write( "\\\\", 2 ); break;
+                case '/': s.write( "\\/", 2 ); break;
+                case '\b': s.write( "\\b", 2 ); break;
+                case '\f': s.write( "\\f", 2 ); break;
+                case '\n': s.write( "\\n", 2 ); break;
+                case '\r': s.write( "\\r", 2 ); break;
+                case '\t': s.write( "\\t", 2 ); break;
+                default:
                     //TODO: these should be utf16 code-units not bytes
-                    char c = *i;
-                    ret << "\\u00" << toHexLower(&c, 1);
-                } else {
-                    ret << *i;
+                    s.write( "\\u00", 4 );
+                    s << hexchars[ c >> 4 ] << hexchars[ c & 0xf ];
                 }
             }
+            s.write( run, (int) ( end - run ) );
+        }
+
+        void appendEscaped( StringBuilder& s, const char *str, bool escape_slash = false ) {
+            appendEscaped( s, str, (int) strlen( str ), escape_slash );
+        }
+
+        void appendUnsigned( StringBuilder& s, unsigned long long x ) {
+            char buf[24];
+            char *p = buf + sizeof( buf );
+            do {
+                *--p = (char) ( '0' + x % 10 );
+                x /= 10;
+            } while ( x );
+            s.write( p, (int) ( buf + sizeof( buf ) - p ) );
+        }
+
+        void appendLong( StringBuilder& s, long long x ) {
+            if ( x < 0 ) {
+                s << '-';
+                appendUnsigned( s, 0 - (unsigned long long) x );
+            }
+            else {
+                appendUnsigned( s, x );
+            }
+        }
+
+        /** same output as a stream with precision 16 */
+        void appendDouble( StringBuilder& s, double x ) {
+            // integral values below 1e15 print all their digits and no exponent under %.16g.  -0 doesn't take this path.
+            if ( x != 0 && x > -1e15 && x < 1e15 && x == (double) (long long) x ) {
+                appendLong( s, (long long) x );
+                return;
+            }
+            char buf[32];
+            int n = sprintf( buf, "%.16g", x );
+            s.write( buf, n );
+        }
+
+        void appendOid( StringBuilder& s, const OID& oid ) {
+            const unsigned char *p = (const unsigned char *) oid.getData();
+            char buf[24];
+            for ( int i = 0; i < 12; ++i ) {
+                buf[ i * 2 ] = hexchars[ p[ i ] >> 4 ];
+                buf[ i * 2 + 1 ] = hexchars[ p[ i ] & 0xf ];
+            }
+            s.write( buf, 24 );
         }
-        return ret.str();
     }
 
     string BSONElement::jsonString( JsonStringFormat format, bool includeFieldNames, int pretty ) const {
+        StringBuilder s;
+        jsonString( s, format, includeFieldNames, pretty );
+        return s.str();
+    }
+
+    void BSONElement::jsonString( StringBuilder& s, JsonStringFormat format, bool includeFieldNames, int pretty ) const {
         BSONType t = type();
         if ( t == Undefined )
-            return "";
+            return;
 
-        stringstream s;
-        if ( includeFieldNames )
-            s << '"' << escape( fieldName() ) << "\" : ";
+        if ( includeFieldNames ) {
+            s << '"';
+            appendEscaped( s, fieldName() );
+            s << "\" : ";
+        }
         switch ( type() ) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape( string(valuestr(), valuestrsize()-1) ) << '"';
+            s << '"';
+            appendEscaped( s, valuestr(), valuestrsize()-1 );
+            s << '"';
             break;
         case NumberLong:
-            s << _numberLong();
+            appendLong( s, _numberLong() );
             break;
         case NumberInt:
+            appendLong( s, _numberInt() );
+            break;
         case NumberDouble:
             if ( number() >= -numeric_limits< double >::max() &&
                     number() <= numeric_limits< double >::max() ) {
-                s.precision( 16 );
-                s << number();
+                appendDouble( s, number() );
             } else {
                 StringBuilder ss;
                 ss << "Number " << number() << " cannot be represented in JSON";
@@ -129,7 +181,7 @@ namespace mongo {
             s << "null";
             break;
         case Object:
-            s << embeddedObject().jsonString( format, pretty );
+            embeddedObject().jsonString( s, format, pretty );
             break;
         case mongo::Array: {
             if ( embeddedObject().isEmpty() ) {
@@ -146,7 +198,7 @@ namespace mongo {
                         for( int x = 0; x < pretty; x++ )
                             s << "  ";
                     }
-                    s << e.jsonString( format, false, pretty?pretty+1:0 );
+                    e.jsonString( s, format, false, pretty?pretty+1:0 );
                     e = i.next();
                     if ( e.eoo() )
                         break;
@@ -164,7 +216,9 @@ namespace mongo {
             s << '"' << valuestr() << "\", ";
             if ( format != TenGen )
                 s << "\"$id\" : ";
-            s << '"' << *x << "\" ";
+            s << '"';
+            appendOid( s, *x );
+            s << "\" ";
             if ( format == TenGen )
                 s << ')';
             else
@@ -177,7 +231,9 @@ namespace mongo {
             } else {
                 s << "{ \"$oid\" : ";
             }
-            s << '"' << __oid() << '"';
+            s << '"';
+            appendOid( s, __oid() );
+            s << '"';
             if ( format == TenGen ) {
                 s << " )";
             } else {
@@ -186,14 +242,11 @@ namespace mongo {
             break;
         case BinData: {
             int len = *(int *)( value() );
-            BinDataType type = BinDataType( *(char *)( (int *)( value() ) + 1 ) );
+            unsigned char type = *(unsigned char *)( (int *)( value() ) + 1 );
             s << "{ \"$binary\" : \"";
             char *start = ( char * )( value() ) + sizeof( int ) + 1;
             base64::encode( s , start , len );
-            s << "\", \"$type\" : \"" << hex;
-            s.width( 2 );
-            s.fill( '0' );
-            s << type << dec;
+            s << "\", \"$type\" : \"" << hexchars[ type >> 4 ] << hexchars[ type & 0xf ];
             s << "\" }";
             break;
         }
@@ -208,7 +261,7 @@ namespace mongo {
                 else
                     s << '"' << date().toString() << '"';
             } else
-                s << date();
+                appendUnsigned( s, date() );
             if ( format == Strict )
                 s << " }";
             else
@@ -216,10 +269,13 @@ namespace mongo {
             break;
         case RegEx:
             if ( format == Strict ){
-                s << "{ \"$regex\" : \"" << escape( regex() );
+                s << "{ \"$regex\" : \"";
+                appendEscaped( s, regex() );
                 s << "\", \"$options\" : \"" << regexFlags() << "\" }";
             } else {
-                s << "/" << escape( regex() , true ) << "/";
+                s << "/";
+                appendEscaped( s, regex(), true );
+                s << "/";
                 // FIXME Worry about alpha order?
                 for ( const char *f = regexFlags(); *f; ++f ){
                     switch ( *f ) {
@@ -238,7 +294,9 @@ namespace mongo {
             BSONObj scope = codeWScopeObject();
             if ( ! scope.isEmpty() ){
                 s << "{ \"$code\" : " << _asCode() << " , "
-                  << " \"$scope\" : " << scope.jsonString() << " }";
+                  << " \"$scope\" : ";
+                scope.jsonString( s );
+                s << " }";
                 break;
             }
         }
@@ -249,7 +307,11 @@ namespace mongo {
             break;
             
         case Timestamp:
-            s << "{ \"t\" : " << timestampTime() << " , \"i\" : " << timestampInc() << " }";
+            s << "{ \"t\" : ";
+            appendUnsigned( s, timestampTime() );
+            s << " , \"i\" : ";
+            appendUnsigned( s, timestampInc() );
+            s << " }";
             break;
 
         case MinKey:
@@ -267,7 +329,6 @@ namespace mongo {
             string message = ss.str();
             massert( 10312 ,  message.c_str(), false );
         }
-        return s.str();
     }
 
     int BSONElement::getGtLtOp( int def ) const {
@@ -518,16 +579,24 @@ namespace mongo {
     }
 
     string BSONObj::jsonString( JsonStringFormat format, int pretty ) const {
+        StringBuilder s;
+        jsonString( s, format, pretty );
+        return s.str();
+    }
 
-        if ( isEmpty() ) return "{}";
+    void BSONObj::jsonString( StringBuilder& s, JsonStringFormat format, int pretty ) const {
+
+        if ( isEmpty() ) {
+            s << "{}";
+            return;
+        }
 
-        StringBuilder s;
         s << "{ ";
         BSONObjIterator i(*this);
         BSONElement e = i.next();
         if ( !e.eoo() )
             while ( 1 ) {
-                s << e.jsonString( format, true, pretty?pretty+1:0 );
+                e.jsonString( s, format, true, pretty?pretty+1:0 );
                 e = i.next();
                 if ( e.eoo() )
                     break;
@@ -542,32 +611,141 @@ namespace mongo {
                 }
             }
         s << " }";
-        return s.str();
+    }
+
+    /* validation without building BSONElements or throwing: each element is checked against the
+       bytes left in its enclosing object, and names and C strings are measured with memchr, which
+       the C library scans a word or vector at a time.
+    */
+    namespace {
+        inline int readInt( const char *p ) { return *reinterpret_cast< const int * >( p ); }
+
+        /** @return length of the NUL terminated string at p including the NUL, or -1 if it doesn't end before end */
+        inline int cstrSize( const char *p, const char *end ) {
+            const char *z = (const char *) memchr( p, 0, end - p );
+            return z ? (int) ( z - p ) + 1 : -1;
+        }
+
+        /** @return true if p..p+len holds a string with its int32 length prefix */
+        inline bool validString( const char *p, const char *end, int *len ) {
+            if ( end - p < 5 )
+                return false;
+            int x = readInt( p );
+            if ( x <= 0 || x > end - p - 4 || p[ 4 + x - 1 ] != 0 )
+                return false;
+            *len = 4 + x;
+            return true;
+        }
+
+        bool validObject( const char *p, int maxLen );
+
+        /** @return size of the value at p, or -1 if it isn't valid */
+        int validValue( BSONType t, const char *p, const char *end ) {
+            if ( p > end )
+                return -1;
+            int len;
+            switch ( t ) {
+            case Undefined:
+            case jstNULL:
+            case MaxKey:
+            case MinKey:
+                return 0;
+            case Bool:
+                return end - p >= 1 ? 1 : -1;
+            case NumberInt:
+                return end - p >= 4 ? 4 : -1;
+            case Timestamp:
+            case Date:
+            case NumberDouble:
+            case NumberLong:
+                return end - p >= 8 ? 8 : -1;
+            case jstOID:
+                return end - p >= 12 ? 12 : -1;
+            case Symbol:
+            case Code:
+            case String:
+                return validString( p, end, &len ) ? len : -1;
+            case DBRef:
+                return validString( p, end, &len ) && end - p - len >= 12 ? len + 12 : -1;
+            case BinData: {
+                if ( end - p < 5 )
+                    return -1;
+                int x = readInt( p );
+                return x >= 0 && x <= end - p - 5 ? x + 5 : -1;
+            }
+            case RegEx: {
+                int a = cstrSize( p, end );
+                if ( a < 0 )
+                    return -1;
+                int b = cstrSize( p + a, end );
+                return b < 0 ? -1 : a + b;
+            }
+            case Object:
+            case Array:
+                if ( end - p < 5 || !validObject( p, (int) ( end - p ) ) )
+                    return -1;
+                return readInt( p );
+            case CodeWScope: {
+                if ( end - p < 4 )
+                    return -1;
+                int total = readInt( p );
+                if ( total < 4 + 5 + 5 || total > end - p )
+                    return -1;
+                if ( !validString( p + 4, p + total, &len ) )
+                    return -1;
+                const char *scope = p + 4 + len;
+                if ( !validObject( scope, (int) ( p + total - scope ) ) || readInt( scope ) != p + total - scope )
+                    return -1;
+                return total;
+            }
+            default:
+                return -1;
+            }
+        }
+
+        bool validObject( const char *p, int maxLen ) {
+            if ( maxLen < 5 )
+                return false;
+            int size = readInt( p );
+            if ( size < 5 || size > maxLen || p[ size - 1 ] != EOO )
+                return false;
+            const char *end = p + size;
+            p += 4;
+            while ( 1 ) {
+                if ( p >= end )
+                    return false;
+                BSONType t = (BSONType) *p;
+                if ( t == EOO )
+                    return p == end - 1;
+                int nameSize = cstrSize( p + 1, end );
+                if ( nameSize < 0 )
+                    return false;
+                const char *value = p + 1 + nameSize;
+                int valueSize = validValue( t, value, end - 1 );
+                if ( valueSize < 0 )
+                    return false;
+                p = value + valueSize;
+            }
+        }
     }
 
     bool BSONObj::valid() const {
-        try{
-            BSONObjIterator it(*this);
-            while( it.moreWithEOO() ){
-                // both throw exception on failure
-                BSONElement e = it.next(true);
-                e.validate();
-
-                if (e.eoo()){
-                    if (it.moreWithEOO())
-                        return false;
-                    return true;
-                }else if (e.isABSONObj()){
-                    if(!e.embeddedObject().valid())
-                        return false;
-                }else if (e.type() == CodeWScope){
-                    if(!e.codeWScopeObject().valid())
-                        return false;
+        return validObject( objdata(), objsize() );
+    }
+
+    void BSONObj::getFields(unsigned n, const char **fieldNames, BSONElement *fields) const {
+        BSONObjIterator i(*this);
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            const char *p = e.fieldName();
+            for( unsigned j = 0; j < n; j++ ) {
+                if( strcmp(p, fieldNames[j]) == 0 ) {
+                    if( fields[j].eoo() )
+                        fields[j] = e;
+                    break;
                 }
             }
-        } catch (...) {
         }
-        return false;
     }
 
     int BSONObj::woCompare(const BSONObj& r, const Ordering &o, bool considerFieldName) const { 
@@ -18,542 +18,496 @@
 
 #include "pch.h"
 
-#define BOOST_SPIRIT_THREADSAFE
-#if BOOST_VERSION >= 103800
-#define BOOST_SPIRIT_USE_OLD_NAMESPACE
-#include <boost/spirit/include/classic_core.hpp>
-#include <boost/spirit/include/classic_loops.hpp>
-#include <boost/spirit/include/classic_lists.hpp>
-#else
-#include <boost/spirit/core.hpp>
-#include <boost/spirit/utility/loops.hpp>
-#include <boost/spirit/utility/lists.hpp>
-#endif
-#undef assert
-#define assert MONGO_assert
-
 #include "json.h"
 #include "../bson/util/builder.h"
 #include "../util/base64.h"
 #include "../util/hex.h"
 
-
-using namespace boost::spirit;
-
 namespace mongo {
 
-    struct ObjectBuilder : boost::noncopyable {
-        ~ObjectBuilder(){
-            unsigned i = builders.size();
-            if ( i ){
-                i--;
-                for ( ; i>=1; i-- ){
-                    if ( builders[i] ){
-                        builders[i]->done();
-                    }
-                }
-            }
-        }
-        BSONObjBuilder *back() {
-            return builders.back().get();
-        }
-        // Storage for field names of elements within builders.back().
-        const char *fieldName() {
-            return fieldNames.back().c_str();
-        }
-        bool empty() const {
-            return builders.size() == 0;
-        }
-        void init() {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder() );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        void pushObject( const char *fieldName ) {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder( builders.back()->subobjStart( fieldName ) ) );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        void pushArray( const char *fieldName ) {
-            boost::shared_ptr< BSONObjBuilder > b( new BSONObjBuilder( builders.back()->subarrayStart( fieldName ) ) );
-            builders.push_back( b );
-            fieldNames.push_back( "" );
-            indexes.push_back( 0 );
-        }
-        BSONObj pop() {
-            BSONObj ret;
-            if ( back()->owned() )
-                ret = back()->obj();
-            else
-                ret = back()->done();
-            builders.pop_back();
-            fieldNames.pop_back();
-            indexes.pop_back();
-            return ret;
-        }
-        void nameFromIndex() {
-            fieldNames.back() = BSONObjBuilder::numStr( indexes.back() );
-        }
-        string popString() {
-            string ret = ss.str();
-            ss.str( "" );
-            return ret;
-        }
-        // Cannot use auto_ptr because its copy constructor takes a non const reference.
-        vector< boost::shared_ptr< BSONObjBuilder > > builders;
-        vector< string > fieldNames;
-        vector< int > indexes;
-        stringstream ss;
-        string ns;
+    // NOTE s must be 24 characters.
+    OID stringToOid( const char *s ) {
         OID oid;
-        string binData;
-        BinDataType binDataType;
-        string regex;
-        string regexOptions;
-        Date_t date;
-    };
-
-    struct objectStart {
-        objectStart( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            if ( b.empty() )
-                b.init();
-            else
-                b.pushObject( b.fieldName() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayStart {
-        arrayStart( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            b.pushArray( b.fieldName() );
-            b.nameFromIndex();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayNext {
-        arrayNext( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char &c ) const {
-            ++b.indexes.back();
-            b.nameFromIndex();
-        }
-        ObjectBuilder &b;
-    };
+        char *oidP = (char *)( &oid );
+        for ( int i = 0; i < 12; ++i )
+            oidP[ i ] = fromHex( s + ( i * 2 ) );
+        return oid;
+    }
 
-    struct ch {
-        ch( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            b.ss << c;
+    /* A single pass recursive descent parser that appends straight into BSONObjBuilders.  It accepts
+       the same language as the boost::spirit grammar it replaced:
+
+         object   : '{' [ name ':' value ( ',' name ':' value )* ] '}'
+         name     : dquoted | squoted | [A-Za-z$_][A-Za-z0-9$_]*
+         value    : dquoted | real | integer | array | true | false | null | squoted
+                  | date | oid | bindata | dbref | regex | object
+         date     : { "$date" : uint } | [new] Date( uint )
+         oid      : { "$oid" : "<24 hex>" } | ObjectId( "<24 hex>" )
+         bindata  : { "$binary" : "<base64>", "$type" : "<2 hex>" }
+         dbref    : { "$ref" : dquoted, "$id" : "<24 hex>" } | Dbref( dquoted, "<24 hex>" )
+         regex    : { "$regex" : dquoted, "$options" : "<letters>" } | /chars/[igm]*
+
+       whitespace may separate any two tokens.  The extended forms that start with '{' are tried
+       first and, if they don't match in full, the input is reparsed as a plain object -- where the
+       reserved names ($oid, $date, ...) are rejected, as before.  Nothing is appended for an
+       extended form until it has matched completely.
+    */
+    class JParse {
+    public:
+        JParse( const char *str ) : _p( str ) { }
+
+        /** parse the object at the start of the input into b.  @return false on a syntax error */
+        bool object( BSONObjBuilder &b ) {
+            skipWhite();
+            if ( !accept( '{' ) )
+                return false;
+            return members( b );
+        }
+
+        void skipWhite() {
+            while ( isspace( (unsigned char) *_p ) )
+                ++_p;
+        }
+
+        const char *pos() const { return _p; }
+
+    private:
+        /** the rest of an object after its '{' */
+        bool members( BSONObjBuilder &b ) {
+            if ( token( '}' ) )
+                return true;
+            while ( 1 ) {
+                string name;
+                if ( !fieldName( name ) || !token( ':' ) || !value( b, name.c_str() ) )
+                    return false;
+                if ( token( '}' ) )
+                    return true;
+                if ( !token( ',' ) )
+                    return false;
+            }
         }
-        ObjectBuilder &b;
-    };
 
-    struct chE {
-        chE( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            char o = '\0';
-            switch ( c ) {
-            case '\"':
-                o = '\"';
-                break;
-            case '\'':
-                o = '\'';
-                break;
-            case '\\':
-                o = '\\';
-                break;
+        bool fieldName( string &name ) {
+            skipWhite();
+            if ( *_p == '"' || *_p == '\'' ) {
+                if ( !quoted( name ) )
+                    return false;
+                massert( 10338 ,  "Invalid use of reserved field name",
+                         name != "$oid" &&
+                         name != "$binary" &&
+                         name != "$type" &&
+                         name != "$date" &&
+                         name != "$regex" &&
+                         name != "$options" );
+                return true;
+            }
+            // We allow a subset of valid js identifier names here.
+            const char *start = _p;
+            if ( !( isalpha( (unsigned char) *_p ) || *_p == '$' || *_p == '_' ) )
+                return false;
+            ++_p;
+            while ( isalnum( (unsigned char) *_p ) || *_p == '$' || *_p == '_' )
+                ++_p;
+            name.assign( start, _p - start );
+            return true;
+        }
+
+        bool value( BSONObjBuilder &b, const char *name ) {
+            skipWhite();
+            switch ( *_p ) {
+            case '"':
+            case '\'': {
+                string s;
+                if ( !quoted( s ) )
+                    return false;
+                b.append( name, s );
+                return true;
+            }
+            case '[':
+                ++_p;
+                return array( b, name );
+            case '{':
+                ++_p;
+                return extendedObject( b, name ) || subobject( b, name );
             case '/':
-                o = '/';
-                break;
-            case 'b':
-                o = '\b';
-                break;
+                return regex( b, name );
+            case 't':
+                if ( literal( "true" ) ) {
+                    b.appendBool( name, true );
+                    return true;
+                }
+                return false;
             case 'f':
-                o = '\f';
-                break;
+                if ( literal( "false" ) ) {
+                    b.appendBool( name, false );
+                    return true;
+                }
+                return false;
             case 'n':
-                o = '\n';
-                break;
-            case 'r':
-                o = '\r';
-                break;
-            case 't':
-                o = '\t';
-                break;
-            case 'v':
-                o = '\v';
-                break;
+                if ( literal( "null" ) ) {
+                    b.appendNull( name );
+                    return true;
+                }
+                return dateCall( b, name );
+            case 'D':
+                return dateCall( b, name ) || dbrefCall( b, name );
+            case 'O': {
+                OID oid;
+                if ( !literal( "ObjectId" ) || !token( '(' ) || !quotedOid( oid ) || !token( ')' ) )
+                    return false;
+                b.appendOID( name, &oid );
+                return true;
+            }
             default:
-                assert( false );
+                return number( b, name );
             }
-            b.ss << o;
         }
-        ObjectBuilder &b;
-    };
 
-    struct chU {
-        chU( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            unsigned char first = fromHex( start );
-            unsigned char second = fromHex( start + 2 );
-            if ( first == 0 && second < 0x80 )
-                b.ss << second;
-            else if ( first < 0x08 ) {
-                b.ss << char( 0xc0 | ( ( first << 2 ) | ( second >> 6 ) ) );
-                b.ss << char( 0x80 | ( ~0xc0 & second ) );
-            } else {
-                b.ss << char( 0xe0 | ( first >> 4 ) );
-                b.ss << char( 0x80 | ( ~0xc0 & ( ( first << 2 ) | ( second >> 6 ) ) ) );
-                b.ss << char( 0x80 | ( ~0xc0 & second ) );
+        bool subobject( BSONObjBuilder &b, const char *name ) {
+            BSONObjBuilder sub( b.subobjStart( name ) );
+            if ( !members( sub ) )
+                return false;
+            sub.done();
+            return true;
+        }
+
+        /** the rest of an array after its '[' */
+        bool array( BSONObjBuilder &b, const char *name ) {
+            BSONObjBuilder sub( b.subarrayStart( name ) );
+            if ( !token( ']' ) ) {
+                int i = 0;
+                while ( 1 ) {
+                    if ( !value( sub, BSONObjBuilder::numStr( i++ ).c_str() ) )
+                        return false;
+                    if ( token( ']' ) )
+                        break;
+                    if ( !token( ',' ) )
+                        return false;
+                }
+            }
+            sub.done();
+            return true;
+        }
+
+        /** try the { "$..." : ... } forms; on failure the position is left just past the '{' */
+        bool extendedObject( BSONObjBuilder &b, const char *name ) {
+            const char *start = _p;
+            skipWhite();
+            bool ok = false;
+            if ( literal( "\"$date\"" ) ) {
+                Date_t d;
+                ok = token( ':' ) && unsignedNumber( d ) && token( '}' );
+                if ( ok )
+                    b.appendDate( name, d );
+            }
+            else if ( literal( "\"$oid\"" ) ) {
+                OID oid;
+                ok = token( ':' ) && quotedOid( oid ) && token( '}' );
+                if ( ok )
+                    b.appendOID( name, &oid );
+            }
+            else if ( literal( "\"$binary\"" ) ) {
+                string data;
+                BinDataType type;
+                ok = token( ':' ) && base64( data ) && token( ',' ) && tokenLiteral( "\"$type\"" ) &&
+                     token( ':' ) && binDataType( type ) && token( '}' );
+                if ( ok )
+                    b.appendBinData( name, data.length(), type, data.data() );
+            }
+            else if ( literal( "\"$ref\"" ) ) {
+                string ns;
+                OID oid;
+                ok = token( ':' ) && doubleQuoted( ns ) && token( ',' ) && tokenLiteral( "\"$id\"" ) &&
+                     token( ':' ) && quotedOid( oid ) && token( '}' );
+                if ( ok )
+                    b.appendDBRef( name, ns, oid );
+            }
+            else if ( literal( "\"$regex\"" ) ) {
+                string re;
+                string options;
+                ok = token( ':' ) && doubleQuoted( re ) && token( ',' ) && tokenLiteral( "\"$options\"" ) &&
+                     token( ':' ) && token( '"' ) && letters( options ) && accept( '"' ) && token( '}' );
+                if ( ok )
+                    b.appendRegex( name, re, options );
+            }
+            if ( !ok )
+                _p = start;
+            return ok;
+        }
+
+        bool dateCall( BSONObjBuilder &b, const char *name ) {
+            const char *start = _p;
+            if ( literal( "new" ) )
+                skipWhite();
+            Date_t d;
+            if ( literal( "Date" ) && token( '(' ) && unsignedNumber( d ) && token( ')' ) ) {
+                b.appendDate( name, d );
+                return true;
+            }
+            _p = start;
+            return false;
+        }
+
+        bool dbrefCall( BSONObjBuilder &b, const char *name ) {
+            string ns;
+            OID oid;
+            if ( !literal( "Dbref" ) || !token( '(' ) || !doubleQuoted( ns ) ||
+                 !token( ',' ) || !quotedOid( oid ) || !token( ')' ) )
+                return false;
+            b.appendDBRef( name, ns, oid );
+            return true;
+        }
+
+        bool regex( BSONObjBuilder &b, const char *name ) {
+            ++_p; // '/'
+            string re;
+            while ( *_p != '/' ) {
+                unsigned char c = *_p;
+                if ( c <= 0x1f )
+                    return false;
+                ++_p;
+                if ( c != '\\' ) {
+                    re += (char) c;
+                    continue;
+                }
+                c = *_p;
+                if ( c == 0 )
+                    return false;
+                ++_p;
+                switch ( c ) {
+                case '"': re += '"'; break;
+                case '\\': re += '\\'; break;
+                case '/': re += '/'; break;
+                case 'b': re += '\b'; break;
+                case 'f': re += '\f'; break;
+                case 'n': re += '\n'; break;
+                case 'r': re += '\r'; break;
+                case 't': re += '\t'; break;
+                case 'u':
+                    if ( !unicodeEscape( re ) )
+                        return false;
+                    break;
+                default:
+                    return false;
+                }
+            }
+            ++_p;
+            const char *options = _p;
+            while ( *_p == 'i' || *_p == 'g' || *_p == 'm' )
+                ++_p;
+            b.appendRegex( name, re, string( options, _p - options ) );
+            return true;
+        }
+
+        /** a real if the token has a '.' or an exponent, otherwise a 32 or 64 bit integer */
+        bool number( BSONObjBuilder &b, const char *name ) {
+            const char *start = _p;
+            const char *q = _p;
+            if ( *q == '-' || *q == '+' )
+                ++q;
+            const char *digits = q;
+            while ( isdigit( (unsigned char) *q ) )
+                ++q;
+            bool real = false;
+            bool anyDigits = q > digits;
+            if ( *q == '.' ) {
+                const char *frac = ++q;
+                while ( isdigit( (unsigned char) *q ) )
+                    ++q;
+                anyDigits = anyDigits || q > frac;
+                real = true;
+            }
+            if ( !anyDigits )
+                return false;
+            if ( *q == 'e' || *q == 'E' ) {
+                const char *e = q + 1;
+                if ( *e == '-' || *e == '+' )
+                    ++e;
+                if ( isdigit( (unsigned char) *e ) ) {
+                    while ( isdigit( (unsigned char) *e ) )
+                        ++e;
+                    q = e;
+                    real = true;
+                }
             }
-        }
-        ObjectBuilder &b;
-    };
-
-    struct chClear {
-        chClear( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char c ) const {
-            b.popString();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct fieldNameEnd {
-        fieldNameEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            string name = b.popString();
-            massert( 10338 ,  "Invalid use of reserved field name",
-                     name != "$oid" &&
-                     name != "$binary" &&
-                     name != "$type" &&
-                     name != "$date" &&
-                     name != "$regex" &&
-                     name != "$options" );
-            b.fieldNames.back() = name;
-        }
-        ObjectBuilder &b;
-    };
-
-    struct unquotedFieldNameEnd {
-        unquotedFieldNameEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            string name( start, end );
-            b.fieldNames.back() = name;
-        }
-        ObjectBuilder &b;
-    };
-
-    struct stringEnd {
-        stringEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->append( b.fieldName(), b.popString() );
-        }
-        ObjectBuilder &b;
-    };
 
-    struct numberValue {
-        numberValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( double d ) const {
-            b.back()->append( b.fieldName(), d );
-        }
-        ObjectBuilder &b;
-    };
+            if ( real ) {
+                b.append( name, strtod( string( start, q - start ).c_str(), 0 ) );
+                _p = q;
+                return true;
+            }
 
-    struct intValue {
-        intValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( long long num ) const {
-            if (num >= numeric_limits<int>::min() && num <= numeric_limits<int>::max())
-                b.back()->append( b.fieldName(), (int)num );
+            // accumulate toward the sign so the most negative long long can be read
+            bool negative = *start == '-';
+            const long long limit = negative ? numeric_limits<long long>::min() : -numeric_limits<long long>::max();
+            long long n = 0;
+            for ( const char *d = digits; d < q; ++d ) {
+                int x = *d - '0';
+                if ( n < limit / 10 || n * 10 < limit + x )
+                    return false;
+                n = n * 10 - x;
+            }
+            if ( !negative )
+                n = -n;
+            if ( n >= numeric_limits<int>::min() && n <= numeric_limits<int>::max() )
+                b.append( name, (int) n );
             else
-                b.back()->append( b.fieldName(), num );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct subobjectEnd {
-        subobjectEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.pop();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct arrayEnd {
-        arrayEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.pop();
-        }
-        ObjectBuilder &b;
-    };
-
-    struct trueValue {
-        trueValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBool( b.fieldName(), true );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct falseValue {
-        falseValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBool( b.fieldName(), false );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct nullValue {
-        nullValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendNull( b.fieldName() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct dbrefNS {
-        dbrefNS( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.ns = b.popString();
-        }
-        ObjectBuilder &b;
-    };
-
-// NOTE s must be 24 characters.
-    OID stringToOid( const char *s ) {
-        OID oid;
-        char *oidP = (char *)( &oid );
-        for ( int i = 0; i < 12; ++i )
-            oidP[ i ] = fromHex( s + ( i * 2 ) );
-        return oid;
-    }
-
-    struct oidValue {
-        oidValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.oid = stringToOid( start );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct dbrefEnd {
-        dbrefEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendDBRef( b.fieldName(), b.ns, b.oid );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct oidEnd {
-        oidEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendOID( b.fieldName(), &b.oid );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataBinary {
-        binDataBinary( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
+                b.append( name, n );
+            _p = q;
+            return true;
+        }
+
+        bool unsignedNumber( Date_t &d ) {
+            skipWhite();
+            if ( !isdigit( (unsigned char) *_p ) )
+                return false;
+            unsigned long long n = 0;
+            while ( isdigit( (unsigned char) *_p ) ) {
+                unsigned x = *_p - '0';
+                if ( n > ( numeric_limits<unsigned long long>::max() - x ) / 10 )
+                    return false;
+                n = n * 10 + x;
+                ++_p;
+            }
+            d = n;
+            return true;
+        }
+
+        bool quotedOid( OID &oid ) {
+            skipWhite();
+            if ( *_p != '"' )
+                return false;
+            for ( int i = 1; i <= 24; ++i )
+                if ( !isxdigit( (unsigned char) _p[ i ] ) )
+                    return false;
+            if ( _p[ 25 ] != '"' )
+                return false;
+            oid = stringToOid( _p + 1 );
+            _p += 26;
+            return true;
+        }
+
+        bool base64( string &data ) {
+            if ( !token( '"' ) )
+                return false;
+            const char *start = _p;
+            while ( isalnum( (unsigned char) *_p ) || *_p == '+' || *_p == '/' )
+                ++_p;
+            while ( *_p == '=' )
+                ++_p;
+            const char *end = _p;
+            if ( !accept( '"' ) )
+                return false;
             massert( 10339 ,  "Badly formatted bindata", ( end - start ) % 4 == 0 );
-            string encoded( start, end );
-            b.binData = base64::decode( encoded );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataType {
-        binDataType( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.binDataType = BinDataType( fromHex( start ) );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct binDataEnd {
-        binDataEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendBinData( b.fieldName(), b.binData.length(),
-                                     b.binDataType, b.binData.data() );
-        }
-        ObjectBuilder &b;
-    };
-
-    struct dateValue {
-        dateValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( Date_t v ) const {
-            b.date = v;
+            data = base64::decode( string( start, end ) );
+            return true;
+        }
+
+        bool binDataType( BinDataType &type ) {
+            if ( !token( '"' ) || !isxdigit( (unsigned char) _p[ 0 ] ) || !isxdigit( (unsigned char) _p[ 1 ] ) || _p[ 2 ] != '"' )
+                return false;
+            type = BinDataType( fromHex( _p ) );
+            _p += 3;
+            return true;
+        }
+
+        bool letters( string &s ) {
+            const char *start = _p;
+            while ( isalpha( (unsigned char) *_p ) )
+                ++_p;
+            s.assign( start, _p - start );
+            return true;
+        }
+
+        bool doubleQuoted( string &s ) {
+            skipWhite();
+            return *_p == '"' && quoted( s );
+        }
+
+        /** a '"' or '\'' delimited string, starting at the opening quote */
+        bool quoted( string &s ) {
+            const char quote = *_p++;
+            while ( *_p != quote ) {
+                unsigned char c = *_p;
+                if ( c <= 0x1f )
+                    return false;
+                ++_p;
+                if ( c != '\\' ) {
+                    s += (char) c;
+                    continue;
+                }
+                c = *_p;
+                if ( c == 'x' || c == 0 || isdigit( c ) ) // hex and octal aren't supported
+                    return false;
+                ++_p;
+                switch ( c ) {
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'v': s += '\v'; break;
+                case 'u':
+                    if ( !unicodeEscape( s ) )
+                        return false;
+                    break;
+                default:
+                    s += (char) c;
+                }
+            }
+            ++_p;
+            return true;
+        }
+
+        /** the 4 hex digits after \u, appended as utf8 */
+        bool unicodeEscape( string &s ) {
+            for ( int i = 0; i < 4; ++i )
+                if ( !isxdigit( (unsigned char) _p[ i ] ) )
+                    return false;
+            unsigned char first = fromHex( _p );
+            unsigned char second = fromHex( _p + 2 );
+            _p += 4;
+            if ( first == 0 && second < 0x80 )
+                s += (char) second;
+            else if ( first < 0x08 ) {
+                s += char( 0xc0 | ( ( first << 2 ) | ( second >> 6 ) ) );
+                s += char( 0x80 | ( ~0xc0 & second ) );
+            } else {
+                s += char( 0xe0 | ( first >> 4 ) );
+                s += char( 0x80 | ( ~0xc0 & ( ( first << 2 ) | ( second >> 6 ) ) ) );
+                s += char( 0x80 | ( ~0xc0 & second ) );
+            }
+            return true;
         }
-        ObjectBuilder &b;
-    };
 
-    struct dateEnd {
-        dateEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendDate( b.fieldName(), b.date );
+        bool accept( char c ) {
+            if ( *_p != c )
+                return false;
+            ++_p;
+            return true;
         }
-        ObjectBuilder &b;
-    };
 
-    struct regexValue {
-        regexValue( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.regex = b.popString();
+        /** c, after optional whitespace */
+        bool token( char c ) {
+            skipWhite();
+            return accept( c );
         }
-        ObjectBuilder &b;
-    };
 
-    struct regexOptions {
-        regexOptions( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.regexOptions = string( start, end );
+        /** the exact characters of s, with no whitespace skipped */
+        bool literal( const char *s ) {
+            size_t n = strlen( s );
+            if ( strncmp( _p, s, n ) != 0 )
+                return false;
+            _p += n;
+            return true;
         }
-        ObjectBuilder &b;
-    };
 
-    struct regexEnd {
-        regexEnd( ObjectBuilder &_b ) : b( _b ) {}
-        void operator() ( const char *start, const char *end ) const {
-            b.back()->appendRegex( b.fieldName(), b.regex, b.regexOptions );
+        bool tokenLiteral( const char *s ) {
+            skipWhite();
+            return literal( s );
         }
-        ObjectBuilder &b;
-    };
 
-// One gotcha with this parsing library is probably best ilustrated with an
-// example.  Say we have a production like this:
-// z = ( ch_p( 'a' )[ foo ] >> ch_p( 'b' ) ) | ( ch_p( 'a' )[ foo ] >> ch_p( 'c' ) );
-// On input "ac", action foo() will be called twice -- once as the parser tries
-// to match "ab", again as the parser successfully matches "ac".  Sometimes
-// the grammar can be modified to eliminate these situations.  Here, for example:
-// z = ch_p( 'a' )[ foo ] >> ( ch_p( 'b' ) | ch_p( 'c' ) );
-// However, this is not always possible.  In my implementation I've tried to
-// stick to the following pattern: store fields fed to action callbacks
-// temporarily as ObjectBuilder members, then append to a BSONObjBuilder once
-// the parser has completely matched a nonterminal and won't backtrack.  It's
-// worth noting here that this parser follows a short-circuit convention.  So,
-// in the original z example on line 3, if the input was "ab", foo() would only
-// be called once.
-    struct JsonGrammar : public grammar< JsonGrammar > {
-public:
-        JsonGrammar( ObjectBuilder &_b ) : b( _b ) {}
-
-        template < typename ScannerT >
-        struct definition {
-            definition( JsonGrammar const &self ) {
-                object = ch_p( '{' )[ objectStart( self.b ) ] >> !members >> '}';
-                members = list_p((fieldName >> ':' >> value) , ',');
-                fieldName =
-                    str[ fieldNameEnd( self.b ) ] |
-                    singleQuoteStr[ fieldNameEnd( self.b ) ] |
-                    unquotedFieldName[ unquotedFieldNameEnd( self.b ) ];
-                array = ch_p( '[' )[ arrayStart( self.b ) ] >> !elements >> ']';
-                elements = list_p(value, ch_p(',')[arrayNext( self.b )]);
-                value =
-                    str[ stringEnd( self.b ) ] |
-                    number |
-                    integer |
-                    array[ arrayEnd( self.b ) ] |
-                    lexeme_d[ str_p( "true" ) ][ trueValue( self.b ) ] |
-                    lexeme_d[ str_p( "false" ) ][ falseValue( self.b ) ] |
-                    lexeme_d[ str_p( "null" ) ][ nullValue( self.b ) ] |
-                    singleQuoteStr[ stringEnd( self.b ) ] |
-                    date[ dateEnd( self.b ) ] |
-                    oid[ oidEnd( self.b ) ] |
-                    bindata[ binDataEnd( self.b ) ] |
-                    dbref[ dbrefEnd( self.b ) ] |
-                    regex[ regexEnd( self.b ) ] |
-                    object[ subobjectEnd( self.b ) ] ;
-                // NOTE lexeme_d and rules don't mix well, so we have this mess.
-                // NOTE We use range_p rather than cntrl_p, because the latter is locale dependent.
-                str = lexeme_d[ ch_p( '"' )[ chClear( self.b ) ] >>
-                                *( ( ch_p( '\\' ) >>
-                                     (
-                                       ch_p( 'b' )[ chE( self.b ) ] |
-                                       ch_p( 'f' )[ chE( self.b ) ] |
-                                       ch_p( 'n' )[ chE( self.b ) ] |
-                                       ch_p( 'r' )[ chE( self.b ) ] |
-                                       ch_p( 't' )[ chE( self.b ) ] |
-                                       ch_p( 'v' )[ chE( self.b ) ] |
-                                       ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) |
-                                       ( ~ch_p('x') & (~range_p('0','9'))[ ch( self.b ) ] ) // hex and octal aren't supported
-                                     )
-                                   ) |
-                                   ( ~range_p( 0x00, 0x1f ) & ~ch_p( '"' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> '"' ];
-
-                singleQuoteStr = lexeme_d[ ch_p( '\'' )[ chClear( self.b ) ] >>
-                                *( ( ch_p( '\\' ) >>
-                                     (
-                                       ch_p( 'b' )[ chE( self.b ) ] |
-                                       ch_p( 'f' )[ chE( self.b ) ] |
-                                       ch_p( 'n' )[ chE( self.b ) ] |
-                                       ch_p( 'r' )[ chE( self.b ) ] |
-                                       ch_p( 't' )[ chE( self.b ) ] |
-                                       ch_p( 'v' )[ chE( self.b ) ] |
-                                       ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) |
-                                       ( ~ch_p('x') & (~range_p('0','9'))[ ch( self.b ) ] ) // hex and octal aren't supported
-                                     )
-                                   ) |
-                                   ( ~range_p( 0x00, 0x1f ) & ~ch_p( '\'' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> '\'' ];
-
-                // real_p accepts numbers with nonsignificant zero prefixes, which
-                // aren't allowed in JSON.  Oh well.
-                number = strict_real_p[ numberValue( self.b ) ];
-
-                static int_parser<long long, 10,  1, numeric_limits<long long>::digits10 + 1> long_long_p;
-                integer = long_long_p[ intValue(self.b) ];
-
-                // We allow a subset of valid js identifier names here.
-                unquotedFieldName = lexeme_d[ ( alpha_p | ch_p( '$' ) | ch_p( '_' ) ) >> *( ( alnum_p | ch_p( '$' ) | ch_p( '_'  )) ) ];
-
-                dbref = dbrefS | dbrefT;
-                dbrefS = ch_p( '{' ) >> "\"$ref\"" >> ':' >>
-                         str[ dbrefNS( self.b ) ] >> ',' >> "\"$id\"" >> ':' >> quotedOid >> '}';
-                dbrefT = str_p( "Dbref" ) >> '(' >> str[ dbrefNS( self.b ) ] >> ',' >>
-                         quotedOid >> ')';
-
-                oid = oidS | oidT;
-                oidS = ch_p( '{' ) >> "\"$oid\"" >> ':' >> quotedOid >> '}';
-                oidT = str_p( "ObjectId" ) >> '(' >> quotedOid >> ')';
-
-                quotedOid = lexeme_d[ '"' >> ( repeat_p( 24 )[ xdigit_p ] )[ oidValue( self.b ) ] >> '"' ];
-
-                bindata = ch_p( '{' ) >> "\"$binary\"" >> ':' >>
-                          lexeme_d[ '"' >> ( *( range_p( 'A', 'Z' ) | range_p( 'a', 'z' ) | range_p( '0', '9' ) | ch_p( '+' ) | ch_p( '/' ) ) >> *ch_p( '=' ) )[ binDataBinary( self.b ) ] >> '"' ] >> ',' >> "\"$type\"" >> ':' >>
-                          lexeme_d[ '"' >> ( repeat_p( 2 )[ xdigit_p ] )[ binDataType( self.b ) ] >> '"' ] >> '}';
-
-                // TODO: this will need to use a signed parser at some point
-                date = dateS | dateT;
-                dateS = ch_p( '{' ) >> "\"$date\"" >> ':' >> uint_parser< Date_t >()[ dateValue( self.b ) ] >> '}';
-                dateT = !str_p("new") >> str_p( "Date" ) >> '(' >> uint_parser< Date_t >()[ dateValue( self.b ) ] >> ')';
-
-                regex = regexS | regexT;
-                regexS = ch_p( '{' ) >> "\"$regex\"" >> ':' >> str[ regexValue( self.b ) ] >> ',' >> "\"$options\"" >> ':' >> lexeme_d[ '"' >> ( *( alpha_p ) )[ regexOptions( self.b ) ] >> '"' ] >> '}';
-                // FIXME Obviously it would be nice to unify this with str.
-                regexT = lexeme_d[ ch_p( '/' )[ chClear( self.b ) ] >>
-                                   *( ( ch_p( '\\' ) >>
-                                        ( ch_p( '"' )[ chE( self.b ) ] |
-                                          ch_p( '\\' )[ chE( self.b ) ] |
-                                          ch_p( '/' )[ chE( self.b ) ] |
-                                          ch_p( 'b' )[ chE( self.b ) ] |
-                                          ch_p( 'f' )[ chE( self.b ) ] |
-                                          ch_p( 'n' )[ chE( self.b ) ] |
-                                          ch_p( 'r' )[ chE( self.b ) ] |
-                                          ch_p( 't' )[ chE( self.b ) ] |
-                                          ( ch_p( 'u' ) >> ( repeat_p( 4 )[ xdigit_p ][ chU( self.b ) ] ) ) ) ) |
-                                      ( ~range_p( 0x00, 0x1f ) & ~ch_p( '/' ) & ( ~ch_p( '\\' ) )[ ch( self.b ) ] ) ) >> str_p( "/" )[ regexValue( self.b ) ]
-                                   >> ( *( ch_p( 'i' ) | ch_p( 'g' ) | ch_p( 'm' ) ) )[ regexOptions( self.b ) ] ];
-            }
-            rule< ScannerT > object, members, array, elements, value, str, number, integer,
-            dbref, dbrefS, dbrefT, oid, oidS, oidT, bindata, date, dateS, dateT,
-            regex, regexS, regexT, quotedOid, fieldName, unquotedFieldName, singleQuoteStr;
-            const rule< ScannerT > &start() const {
-                return object;
-            }
-        };
-        ObjectBuilder &b;
+        const char *_p;
     };
 
     BSONObj fromjson( const char *str , int* len) {
@@ -562,19 +516,19 @@ public:
             return BSONObj();
         }
 
-        ObjectBuilder b;
-        JsonGrammar parser( b );
-        parse_info<> result = parse( str, parser, space_p );
-        if (len) {
-            *len = result.stop - str;
-        } else if ( !result.full ) {
-            int limit = strnlen(result.stop , 10);
+        BSONObjBuilder b;
+        JParse parser( str );
+        bool ok = parser.object( b );
+        if ( ok )
+            parser.skipWhite();
+        if ( !ok || ( !len && *parser.pos() != '\0' ) ) {
+            int limit = strnlen( parser.pos() , 10 );
             if (limit == -1) limit = 10;
-            msgasserted(10340, "Failure parsing JSON string near: " + string( result.stop, limit ));
+            msgasserted(10340, "Failure parsing JSON string near: " + string( parser.pos(), limit ));
         }
-        BSONObj ret = b.pop();
-        assert( b.empty() );
-        return ret;
+        if (len)
+            *len = parser.pos() - str;
+        return b.obj();
     }
 
     BSONObj fromjson( const string &str ) {
@@ -132,16 +132,7 @@ namespace mongo {
                     myregex.reset( new vector< RegexMatcher >() );
                 }
                 myregex->push_back( RegexMatcher() );
-                RegexMatcher &rm = myregex->back();
-                rm.re.reset( new pcrecpp::RE( ie.regex(), flags2options( ie.regexFlags() ) ) );
-                rm.fieldName = 0; // no need for field name
-                rm.regex = ie.regex();
-                rm.flags = ie.regexFlags();
-                rm.isNot = false;
-                bool purePrefix;
-                string prefix = simpleRegex(rm.regex, rm.flags, &purePrefix);
-                if (purePrefix)
-                    rm.prefix = prefix;
+                myregex->back().init( 0, ie.regex(), ie.regexFlags(), false ); // no need for field name
             } else {
                 myset->insert(ie);
             }
@@ -154,26 +145,53 @@ namespace mongo {
     }
     
     
+    /* Compiled patterns are immutable, so queries using the same regex share one
+       pcrecpp::RE rather than recompiling it for every Matcher. */
+    class RegexCache {
+    public:
+        RegexCache() : _m( "RegexCache" ) {}
+        shared_ptr< pcrecpp::RE > get( const char *regex, const char *flags ) {
+            pair< string, string > key( regex, flags );
+            scoped_lock lk( _m );
+            map< pair< string, string >, shared_ptr< pcrecpp::RE > >::const_iterator i = _cache.find( key );
+            if ( i != _cache.end() )
+                return i->second;
+            if ( _cache.size() >= MaxSize )
+                _cache.clear();
+            shared_ptr< pcrecpp::RE > re( new pcrecpp::RE( regex, flags2options( flags ) ) );
+            _cache[ key ] = re;
+            return re;
+        }
+    private:
+        enum { MaxSize = 1000 };
+        mongo::mutex _m;
+        map< pair< string, string >, shared_ptr< pcrecpp::RE > > _cache;
+    } regexCache;
+
+    void RegexMatcher::init( const char *_fieldName, const char *_regex, const char *_flags, bool _isNot ) {
+        re = regexCache.get( _regex, _flags );
+        fieldName = _fieldName;
+        regex = _regex;
+        flags = _flags;
+        isNot = _isNot;
+
+        if (!isNot){ //TODO something smarter
+            bool purePrefix;
+            string p = simpleRegex(regex, flags, &purePrefix);
+            if (purePrefix)
+                prefix = p;
+        }
+        literal = requiredRegexLiteral(regex, flags, &pureLiteral);
+    }
+
     void Matcher::addRegex(const char *fieldName, const char *regex, const char *flags, bool isNot){
 
         if ( nRegex >= 4 ) {
             out() << "ERROR: too many regexes in query" << endl;
         }
         else {
-            RegexMatcher& rm = regexs[nRegex];
-            rm.re.reset( new pcrecpp::RE(regex, flags2options(flags)) );
-            rm.fieldName = fieldName;
-            rm.regex = regex;
-            rm.flags = flags;
-            rm.isNot = isNot;
+            regexs[nRegex].init( fieldName, regex, flags, isNot );
             nRegex++;
-
-            if (!isNot){ //TODO something smarter
-                bool purePrefix;
-                string prefix = simpleRegex(regex, flags, &purePrefix);
-                if (purePrefix)
-                    rm.prefix = prefix;
-            }
         }        
     }
     
@@ -436,10 +454,17 @@ namespace mongo {
         switch (e.type()){
             case String:
             case Symbol:
-                if (rm.prefix.empty())
-                    return rm.re->PartialMatch(e.valuestr());
-                else
+                if (!rm.prefix.empty())
                     return !strncmp(e.valuestr(), rm.prefix.c_str(), rm.prefix.size());
+                if (!rm.literal.empty()) {
+                    // strstr is vectorized in common libcs, so this rejects most
+                    // non-matching strings far more cheaply than pcre
+                    if (!strstr(e.valuestr(), rm.literal.c_str()))
+                        return false;
+                    if (rm.pureLiteral)
+                        return true;
+                }
+                return rm.re->PartialMatch(e.valuestr());
             case RegEx:
                 return !strcmp(rm.regex, e.regex()) && !strcmp(rm.flags, e.regexFlags());
             default:
@@ -864,6 +889,26 @@ namespace mongo {
         return false;
     }
 
+    bool Matcher::hasWhere() const {
+        if ( where )
+            return true;
+        for ( unsigned i=0; i<basics.size() ; i++ ) {
+            const ElementMatcher &bm = basics[i];
+            if ( bm.subMatcher && bm.subMatcher->hasWhere() )
+                return true;
+            for ( vector< shared_ptr<Matcher> >::const_iterator j = bm.allMatchers.begin(); j != bm.allMatchers.end(); ++j )
+                if ( (*j)->hasWhere() )
+                    return true;
+        }
+        for( list< shared_ptr< Matcher > >::const_iterator i = _orMatchers.begin(); i != _orMatchers.end(); ++i )
+            if ( (*i)->hasWhere() )
+                return true;
+        for( list< shared_ptr< Matcher > >::const_iterator i = _norMatchers.begin(); i != _norMatchers.end(); ++i )
+            if ( (*i)->hasWhere() )
+                return true;
+        return false;
+    }
+
     bool Matcher::sameCriteriaCount( const Matcher &other ) const {
         if ( !( basics.size() == other.basics.size() && nRegex == other.nRegex && !where == !other.where ) ) {
             return false;
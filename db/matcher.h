@@ -36,9 +36,13 @@ namespace mongo {
         const char *regex;
         const char *flags;
         string prefix;
+        // substring every match must contain, checked before running pcre
+        string literal;
+        bool pureLiteral;
         shared_ptr< pcrecpp::RE > re;
         bool isNot;
-        RegexMatcher() : isNot() {}
+        RegexMatcher() : pureLiteral(), isNot() {}
+        void init( const char *_fieldName, const char *_regex, const char *_flags, bool _isNot );
     };
     
     struct element_lt
@@ -151,6 +155,10 @@ namespace mongo {
         
         bool hasType( BSONObj::MatchType type ) const;
 
+        /** @return true if this matcher or any nested matcher evaluates $where javascript,
+                    which requires the calling thread's Client */
+        bool hasWhere() const;
+
         string toString() const {
             return jsobj.toString();
         }
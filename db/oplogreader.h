@@ -14,18 +14,30 @@ namespace mongo {
     class OplogReader {
         auto_ptr<DBClientConnection> _conn;
         auto_ptr<DBClientCursor> cursor;
+        string _host;
+        bool _exhaust; // cursor was opened with QueryOption_Exhaust
     public:
 
-        OplogReader() { 
+        OplogReader() : _exhaust(false) { 
         }
         ~OplogReader() { 
         }
 
+        /* an exhaust cursor still streaming hangs up its connection when dropped, so we 
+           reconnect to keep conn() usable (rollback queries on it right after this).
+        */
         void resetCursor() {
+            bool streaming = _exhaust && cursor.get() && !cursor->isDead();
             cursor.reset();
+            _exhaust = false;
+            if( streaming ) {
+                _conn.reset();
+                uassert( 13624 , "repl: couldn't reconnect to " + _host + " after ending exhaust cursor" , connect(_host) );
+            }
         }
         void resetConnection() {
             cursor.reset();
+            _exhaust = false;
             _conn.reset();
         }
         DBClientConnection* conn() { return _conn.get(); }
@@ -49,27 +61,33 @@ namespace mongo {
 
         bool haveCursor() { return cursor.get() != 0; }
 
-        void query(const char *ns, const BSONObj& query) { 
+        /* extraOptions may be QueryOption_Exhaust: the source then streams batches without 
+           waiting for a getMore per batch.  until the cursor is dead, don't use conn() for 
+           anything else without resetCursor() first. 
+        */
+        void query(const char *ns, const BSONObj& query, int extraOptions = 0) { 
             assert( !haveCursor() );
-            cursor = _conn->query(ns, query, 0, 0, 0, QueryOption_SlaveOk);
+            _exhaust = ( extraOptions & QueryOption_Exhaust ) != 0;
+            cursor = _conn->query(ns, query, 0, 0, 0, QueryOption_SlaveOk | extraOptions);
         }
 
-        void tailingQuery(const char *ns, const BSONObj& query) { 
+        void tailingQuery(const char *ns, const BSONObj& query, int extraOptions = 0) { 
             assert( !haveCursor() );
             log(2) << "repl: " << ns << ".find(" << query.toString() << ')' << endl;
+            _exhaust = ( extraOptions & QueryOption_Exhaust ) != 0;
             cursor = _conn->query( ns, query, 0, 0, 0, 
                                   QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay |
                                   /* TODO: slaveok maybe shouldn't use? */
-                                  QueryOption_AwaitData
+                                  QueryOption_AwaitData | extraOptions
                                   );
         }
 
-        void tailingQueryGTE(const char *ns, OpTime t) {
+        void tailingQueryGTE(const char *ns, OpTime t, int extraOptions = 0) {
             BSONObjBuilder q;
             q.appendDate("$gte", t.asDate());
             BSONObjBuilder query;
             query.append("ts", q.done());
-            tailingQuery(ns, query.done());
+            tailingQuery(ns, query.done(), extraOptions);
         }
 
         bool more() { 
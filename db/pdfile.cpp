@@ -41,6 +41,7 @@ _ disallow system* manipulations from the database.
 #include "extsort.h"
 #include "curop-inl.h"
 #include "background.h"
+#include "security.h"
 
 namespace mongo {
 
@@ -788,6 +789,7 @@ namespace mongo {
         result.append("ns", name.c_str());
         ClientCursor::invalidate(name.c_str());
         Client::invalidateNS( name );
+        credentialCache.noteWrite( name.c_str() );
         Top::global.collectionDropped( name );
         dropNS(name);        
     }
@@ -904,6 +906,8 @@ namespace mongo {
             return;
         }
 
+        credentialCache.noteWrite( ns );
+
         /* check if any cursors point to us.  if so, advance them. */
         ClientCursor::aboutToDelete(dl);
 
@@ -914,6 +918,172 @@ namespace mongo {
     }
 
 
+    int followupExtentSize(int len, int lastExtentLen);
+
+    /** allocate lenWHdr bytes for a new record in ns, adding an extent if needed.
+        @param len the object's length, used to size a followup extent
+        @return null if there is no room, which is only expected for capped collections
+    */
+    static DiskLoc allocateSpaceForANewRecord(const char *ns, NamespaceDetails *d, int len, int lenWHdr) {
+        DiskLoc extentLoc;
+        DiskLoc loc = d->alloc(ns, lenWHdr, extentLoc);
+        if ( loc.isNull() ) {
+            // out of space
+            if ( d->capped == 0 ) { // size capped doesn't grow
+                log(1) << "allocating new extent for " << ns << " padding:" << d->paddingFactor << " lenWHdr: " << lenWHdr << endl;
+                cc().database()->allocExtent(ns, followupExtentSize(lenWHdr, d->lastExtentSize), false);
+                loc = d->alloc(ns, lenWHdr, extentLoc);
+                if ( loc.isNull() ){
+                    log() << "WARNING: alloc() failed after allocating new extent. lenWHdr: " << lenWHdr << " last extent size:" << d->lastExtentSize << "; trying again\n";
+                    for ( int zzz=0; zzz<10 && lenWHdr > d->lastExtentSize; zzz++ ){
+                        log() << "try #" << zzz << endl;
+                        cc().database()->allocExtent(ns, followupExtentSize(len, d->lastExtentSize), false);
+                        loc = d->alloc(ns, lenWHdr, extentLoc);
+                        if ( ! loc.isNull() )
+                            break;
+                    }
+                }
+            }
+            if ( loc.isNull() ) {
+                log() << "insert: couldn't alloc space for object ns:" << ns << " capped:" << d->capped << endl;
+                assert(d->capped);
+            }
+        }
+        return loc;
+    }
+
+    /** link a newly allocated, filled in record at the end of its extent's record list and count it */
+    static void addRecordToRecListInExtent(NamespaceDetails *d, Record *r, DiskLoc loc) {
+        {
+            Extent *e = r->myExtent(loc);
+            if ( e->lastRecord.isNull() ) {
+                Extent::FL *fl = getDur().writing(e->fl());
+                fl->firstRecord = fl->lastRecord = loc;
+                r->prevOfs = r->nextOfs = DiskLoc::NullOfs;
+            }
+            else {
+                Record *oldlast = e->lastRecord.rec();
+                r->prevOfs = e->lastRecord.getOfs();
+                r->nextOfs = DiskLoc::NullOfs;
+                getDur().writingInt(oldlast->nextOfs) = loc.getOfs();
+                getDur().writingDiskLoc(e->lastRecord) = loc;
+            }
+        }
+
+        /* durability todo : this could be a bit annoying / slow to record constantly */
+        {
+            NamespaceDetails::Stats *s = getDur().writing(&d->stats);
+            s->datasize += r->netLength();
+            s->nrecords++;
+        }
+    }
+
+    /** overwrite the object stored in r (oldSize bytes) with objNew, which must fit in the record.
+        only the bytes that actually differ are written and declared to the journal: the common
+        leading bytes are skipped, and when the size is unchanged so are the common trailing bytes.
+        when the size changes everything past the first difference shifts, so the tail is rewritten
+        from there on -- for a $push onto a trailing array or a $set near the end of a large object
+        that is a small fraction of the whole.
+    */
+    static void writeChangedBytes(Record *r, int oldSize, const BSONObj& objNew) {
+        char *to = r->data;
+        const char *from = objNew.objdata();
+        int newSize = objNew.objsize();
+
+        int begin = 0;
+        int end = newSize;
+        if( oldSize == newSize ) {
+            while( begin < end && to[begin] == from[begin] )
+                begin++;
+            while( end > begin && to[end-1] == from[end-1] )
+                end--;
+        }
+        else {
+            // the size header differs; write it on its own so the scan below can skip past it
+            *getDur().writing((int *) to) = newSize;
+            begin = sizeof(int);
+            int common = min(oldSize, newSize);
+            while( begin < common && to[begin] == from[begin] )
+                begin++;
+        }
+
+        if( begin < end )
+            memcpy(getDur().writingPtr(to + begin, end - begin), from + begin, end - begin);
+    }
+
+    /** move an updated object that no longer fits in its record to a new record.
+        rather than unindexing every key at the old location and indexing every key again at the new
+        one, index entries for keys the update left alone are pointed at the new location in place;
+        only removed and added keys pay a btree delete or insert.
+    */
+    static DiskLoc moveRecord(const char *ns, NamespaceDetails *d, NamespaceDetailsTransient *nsdt,
+                              Record *toupdate, const DiskLoc& dl, const BSONObj& objNew,
+                              vector<IndexChanges>& changes, OpDebug& debug) {
+        StringBuilder& ss = debug.str;
+        int len = objNew.objsize();
+        int lenWHdr = (int) ((len + Record::HeaderSize) * d->paddingFactor);
+        if ( lenWHdr < len + Record::HeaderSize )
+            lenWHdr = len + Record::HeaderSize;
+        DiskLoc loc = allocateSpaceForANewRecord(ns, d, len, lenWHdr);
+        massert( 13620, "couldn't allocate space to move updated object", !loc.isNull() );
+
+        Record *r = (Record*) getDur().writingPtr(loc.rec(), lenWHdr);
+        memcpy(r->data, objNew.objdata(), len);
+        addRecordToRecListInExtent(d, r, loc);
+
+        /* check if any cursors point to us.  if so, advance them. */
+        ClientCursor::aboutToDelete(dl);
+
+        unsigned keyUpdates = 0;
+        int z = d->nIndexesBeingBuilt();
+        for ( int x = 0; x < z; x++ ) {
+            IndexDetails& idx = d->idx(x);
+            IndexChanges& ch = changes[x];
+            for ( unsigned i = 0; i < ch.removed.size(); i++ ) {
+                try {
+                    idx.head.btree()->unindex(idx.head, idx, *ch.removed[i], dl);
+                }
+                catch (AssertionException&) {
+                    ss << " exception update unindex ";
+                    problem() << " caught assertion update unindex " << idx.indexNamespace() << endl;
+                }
+            }
+            Ordering ordering = Ordering::make(idx.keyPattern());
+            for ( BSONObjSetDefaultOrder::iterator i = ch.oldkeys.begin(); i != ch.oldkeys.end(); i++ ) {
+                if ( ch.newkeys.count(*i) == 0 )
+                    continue;
+                try {
+                    if ( idx.head.btree()->relocate(idx.head, idx, *i, dl, loc) )
+                        continue;
+                    keyUpdates++;
+                    idx.head.btree()->unindex(idx.head, idx, *i, dl);
+                    idx.head.btree()->bt_insert(idx.head, loc, *i, ordering, /*dupsAllowed*/true, idx);
+                }
+                catch (AssertionException& e) {
+                    ss << " exception update index ";
+                    problem() << " caught assertion update index " << idx.indexNamespace() << " " << e << endl;
+                }
+            }
+            keyUpdates += ch.added.size();
+            for ( unsigned i = 0; i < ch.added.size(); i++ ) {
+                try {
+                    /* updateRecord did the dupCheck() already */
+                    idx.head.btree()->bt_insert(idx.head, loc, *ch.added[i], ordering, /*dupsAllowed*/true, idx);
+                }
+                catch (AssertionException& e) {
+                    ss << " exception update index ";
+                    problem() << " caught assertion update index " << idx.indexNamespace() << " " << e << endl;
+                }
+            }
+        }
+        if( keyUpdates && cc().database()->profile )
+            ss << '\n' << keyUpdates << " key updates ";
+
+        theDataFileMgr._deleteRecord(d, ns, toupdate, dl);
+        nsdt->notifyOfWriteOp();
+        return loc;
+    }
+
     /** Note: if the object shrinks a lot, we don't free up space, we leave extra at end of the record.
      */
     const DiskLoc DataFileMgr::updateRecord(
@@ -921,10 +1091,11 @@ namespace mongo {
         NamespaceDetails *d,
         NamespaceDetailsTransient *nsdt,
         Record *toupdate, const DiskLoc& dl,
-        const char *_buf, int _len, OpDebug& debug, bool &changedId, bool god)
+        const char *_buf, int _len, OpDebug& debug, bool &changedId, bool god, IndexUpdateBatch *batch)
     {
         StringBuilder& ss = debug.str;
         dassert( toupdate == dl.rec() );
+        credentialCache.noteWrite( ns );
 
         BSONObj objOld(toupdate);
         BSONObj objNew(_buf);
@@ -957,8 +1128,11 @@ namespace mongo {
             d->paddingTooSmall();
             if ( cc().database()->profile )
                 ss << " moved ";
-            deleteRecord(ns, toupdate, dl);
-            return insert(ns, objNew.objdata(), objNew.objsize(), god);
+            if ( strstr(ns, ".system.") ) {
+                deleteRecord(ns, toupdate, dl);
+                return insert(ns, objNew.objdata(), objNew.objsize(), god);
+            }
+            return moveRecord(ns, d, nsdt, toupdate, dl, objNew, changes, debug);
         }
 
         nsdt->notifyOfWriteOp();
@@ -970,6 +1144,14 @@ namespace mongo {
             int z = d->nIndexesBeingBuilt();
             for ( int x = 0; x < z; x++ ) {
                 IndexDetails& idx = d->idx(x);
+                if ( batch && x < d->nIndexes && !idx.unique() ) {
+                    for ( unsigned i = 0; i < changes[x].removed.size(); i++ )
+                        batch->unindex(x, *changes[x].removed[i], dl);
+                    for ( unsigned i = 0; i < changes[x].added.size(); i++ )
+                        batch->index(x, *changes[x].added[i], dl);
+                    keyUpdates += changes[x].added.size();
+                    continue;
+                }
                 for ( unsigned i = 0; i < changes[x].removed.size(); i++ ) {
                     try {
                         idx.head.btree()->unindex(idx.head, idx, *changes[x].removed[i], dl);
@@ -1001,8 +1183,7 @@ namespace mongo {
         }
 
         //	update in place
-        int sz = objNew.objsize();
-        memcpy(getDur().writingPtr(toupdate->data, sz), objNew.objdata(), sz);
+        writeChangedBytes(toupdate, objOld.objsize(), objNew);
         return dl;
     }
 
@@ -1311,11 +1492,16 @@ namespace mongo {
     }
 
     /* add keys to indexes for a new record */
-    static void indexRecord(NamespaceDetails *d, BSONObj obj, DiskLoc loc) {
+    /** @param batch if given, keys for non unique indexes go into batch.  they are only added once
+               every other index has taken the record, so a dup key failure leaves nothing behind there.
+    */
+    static void indexRecord(NamespaceDetails *d, BSONObj obj, DiskLoc loc, IndexUpdateBatch *batch = 0) {
         int n = d->nIndexesBeingBuilt();
         for ( int i = 0; i < n; i++ ) {
+            bool unique = d->idx(i).unique();
+            if ( batch && !unique && i < d->nIndexes )
+                continue;
             try { 
-                bool unique = d->idx(i).unique();
                 _indexRecord(d, i, obj, loc, /*dupsAllowed*/!unique);
             }
             catch( DBException& ) { 
@@ -1334,6 +1520,19 @@ namespace mongo {
                 throw;
             }
         }
+        if ( batch == 0 )
+            return;
+        for ( int i = 0; i < d->nIndexes; i++ ) {
+            IndexDetails& idx = d->idx(i);
+            if ( idx.unique() )
+                continue;
+            BSONObjSetDefaultOrder keys;
+            idx.getKeysFromObject(obj, keys);
+            if ( keys.size() > 1 )
+                d->setIndexIsMultikey(i);
+            for ( BSONObjSetDefaultOrder::iterator k = keys.begin(); k != keys.end(); k++ )
+                batch->index(i, *k, loc);
+        }
     }
 
     extern BSONObj id_obj; // { _id : 1 }
@@ -1387,8 +1586,8 @@ namespace mongo {
         logOp( "i", ns, tmp );
     }
     
-    DiskLoc DataFileMgr::insertWithObjMod(const char *ns, BSONObj &o, bool god) {
-        DiskLoc loc = insert( ns, o.objdata(), o.objsize(), god );
+    DiskLoc DataFileMgr::insertWithObjMod(const char *ns, BSONObj &o, bool god, IndexUpdateBatch *batch) {
+        DiskLoc loc = insert( ns, o.objdata(), o.objsize(), god, BSONElement(), true, batch );
         if ( !loc.isNull() )
             o = BSONObj( loc.rec() );
         return loc;
@@ -1422,7 +1621,7 @@ namespace mongo {
     /* note: if god==true, you may pass in obuf of NULL and then populate the returned DiskLoc 
              after the call -- that will prevent a double buffer copy in some cases (btree.cpp).
     */
-    DiskLoc DataFileMgr::insert(const char *ns, const void *obuf, int len, bool god, const BSONElement &writeId, bool mayAddIndex) {
+    DiskLoc DataFileMgr::insert(const char *ns, const void *obuf, int len, bool god, const BSONElement &writeId, bool mayAddIndex, IndexUpdateBatch *batch) {
         bool wouldAddIndex = false;
         massert( 10093 , "cannot insert into reserved $ collection", god || isANormalNSName( ns ) );
         uassert( 10094 , "invalid ns", strchr( ns , '.' ) > 0 );
@@ -1443,6 +1642,8 @@ namespace mongo {
             else
                 sys = 0;
         }
+        if ( sys )
+            credentialCache.noteWrite( ns );
 
         bool addIndex = wouldAddIndex && mayAddIndex;
 
@@ -1499,7 +1700,6 @@ namespace mongo {
             BSONElementManipulator::lookForTimestamps( io );
         }
 
-        DiskLoc extentLoc;
         int lenWHdr = len + Record::HeaderSize;
         lenWHdr = (int) (lenWHdr * d->paddingFactor);
         if ( lenWHdr == 0 ) {
@@ -1515,30 +1715,9 @@ namespace mongo {
             checkNoIndexConflicts( d, BSONObj( reinterpret_cast<const char *>( obuf ) ) );
         }
         
-        DiskLoc loc = d->alloc(ns, lenWHdr, extentLoc);
-        if ( loc.isNull() ) {
-            // out of space
-            if ( d->capped == 0 ) { // size capped doesn't grow
-                log(1) << "allocating new extent for " << ns << " padding:" << d->paddingFactor << " lenWHdr: " << lenWHdr << endl;
-                cc().database()->allocExtent(ns, followupExtentSize(lenWHdr, d->lastExtentSize), false);
-                loc = d->alloc(ns, lenWHdr, extentLoc);
-                if ( loc.isNull() ){
-                    log() << "WARNING: alloc() failed after allocating new extent. lenWHdr: " << lenWHdr << " last extent size:" << d->lastExtentSize << "; trying again\n";
-                    for ( int zzz=0; zzz<10 && lenWHdr > d->lastExtentSize; zzz++ ){
-                        log() << "try #" << zzz << endl;
-                        cc().database()->allocExtent(ns, followupExtentSize(len, d->lastExtentSize), false);
-                        loc = d->alloc(ns, lenWHdr, extentLoc);
-                        if ( ! loc.isNull() )
-                            break;
-                    }
-                }
-            }
-            if ( loc.isNull() ) {
-                log() << "insert: couldn't alloc space for object ns:" << ns << " capped:" << d->capped << endl;
-                assert(d->capped);
-                return DiskLoc();
-            }
-        }
+        DiskLoc loc = allocateSpaceForANewRecord(ns, d, len, lenWHdr);
+        if ( loc.isNull() )
+            return DiskLoc();
 
         Record *r = loc.rec();
         {
@@ -1556,28 +1735,7 @@ namespace mongo {
             }
         }
 
-        {
-            Extent *e = r->myExtent(loc);
-            if ( e->lastRecord.isNull() ) {
-                Extent::FL *fl = getDur().writing(e->fl());
-                fl->firstRecord = fl->lastRecord = loc;
-                r->prevOfs = r->nextOfs = DiskLoc::NullOfs;
-            }
-            else {
-                Record *oldlast = e->lastRecord.rec();
-                r->prevOfs = e->lastRecord.getOfs();
-                r->nextOfs = DiskLoc::NullOfs;
-                getDur().writingInt(oldlast->nextOfs) = loc.getOfs();
-                getDur().writingDiskLoc(e->lastRecord) = loc;
-            }
-        }
-
-        /* durability todo : this could be a bit annoying / slow to record constantly */
-        {
-            NamespaceDetails::Stats *s = getDur().writing(&d->stats);
-            s->datasize += r->netLength();
-            s->nrecords++;
-        }
+        addRecordToRecListInExtent(d, r, loc);
 
         // we don't bother clearing those stats for the god tables - also god is true when adidng a btree bucket
         if ( !god )
@@ -1634,7 +1792,7 @@ namespace mongo {
         if ( d->nIndexes ) {
             try { 
                 BSONObj obj(r->data);
-                indexRecord(d, obj, loc);
+                indexRecord(d, obj, loc, d->capped ? 0 : batch);
             } 
             catch( AssertionException& e ) { 
                 // should be a dup key error on _id index
@@ -1735,6 +1893,7 @@ namespace mongo {
         /* why is this not called all the time in closeDatabase?! seems dangerous? */
         /* no path specified here - seems dangerous */
         Client::invalidateDB( d->name );
+        credentialCache.invalidate( d->name );
 
         Database::closeDatabase( d->name.c_str(), d->path );
         d = 0; // d is now deleted
@@ -40,6 +40,7 @@ namespace mongo {
     class Record;
     class Cursor;
     class OpDebug;
+    class IndexUpdateBatch;
 
     void dropDatabase(string db);
     bool repairDatabase(string db, string &errmsg, bool preserveClonedFilesOnFailure = false, bool backupOriginalFiles = false);
@@ -105,25 +106,31 @@ namespace mongo {
         /* see if we can find an extent of the right size in the freelist. */
         static Extent* allocFromFreeList(const char *ns, int approxSize, bool capped = false);
 
-        /** @return DiskLoc where item ends up */
+        /** @return DiskLoc where item ends up
+            @param batch if given, index changes for a record updated where it is may be left in
+                   batch rather than made immediately
+        */
         // changedId should be initialized to false
         const DiskLoc updateRecord(
             const char *ns,
             NamespaceDetails *d,
             NamespaceDetailsTransient *nsdt,
             Record *toupdate, const DiskLoc& dl,
-            const char *buf, int len, OpDebug& debug, bool &changedId, bool god=false);
+            const char *buf, int len, OpDebug& debug, bool &changedId, bool god=false,
+            IndexUpdateBatch *batch=0);
 
         // The object o may be updated if modified on insert.                                
         void insertAndLog( const char *ns, const BSONObj &o, bool god = false );
 
-        /** @param obj both and in and out param -- insert can sometimes modify an object (such as add _id). */
-        DiskLoc insertWithObjMod(const char *ns, BSONObj &o, bool god = false);
+        /** @param obj both and in and out param -- insert can sometimes modify an object (such as add _id).
+            @param batch if given, keys for non unique indexes may be left in batch rather than inserted
+        */
+        DiskLoc insertWithObjMod(const char *ns, BSONObj &o, bool god = false, IndexUpdateBatch *batch = 0);
 
         /** @param obj in value only for this version. */
         void insertNoReturnVal(const char *ns, BSONObj o, bool god = false);
 
-        DiskLoc insert(const char *ns, const void *buf, int len, bool god = false, const BSONElement &writeId = BSONElement(), bool mayAddIndex = true);
+        DiskLoc insert(const char *ns, const void *buf, int len, bool god = false, const BSONElement &writeId = BSONElement(), bool mayAddIndex = true, IndexUpdateBatch *batch = 0);
         static shared_ptr<Cursor> findAll(const char *ns, const DiskLoc &startLoc = DiskLoc());
 
         /* special version of insert for transaction logging -- streamlined a bit.
@@ -198,6 +205,13 @@ namespace mongo {
         DiskLoc getNext(const DiskLoc& myLoc);
         DiskLoc getPrev(const DiskLoc& myLoc);
 
+        /* get the next record in this record's extent, null at the end of the extent */
+        DiskLoc nextInExtent(const DiskLoc& myLoc) {
+            if ( nextOfs == DiskLoc::NullOfs )
+                return DiskLoc();
+            return DiskLoc(myLoc.a(), nextOfs);
+        }
+
         struct NP { 
             int nextOfs;
             int prevOfs;
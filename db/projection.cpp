@@ -120,17 +120,7 @@ namespace mongo {
     }
     
     void Projection::transform( const BSONObj& in , BSONObjBuilder& b ) const {
-        BSONObjIterator i(in);
-        while ( i.more() ){
-            BSONElement e = i.next();
-            if ( mongoutils::str::equals( "_id" , e.fieldName() ) ){
-                if ( _includeID )
-                    b.append( e );
-            }
-            else {
-                append( b , e );
-            }
-        }
+        appendFields( b , in , true );
     }
 
     BSONObj Projection::transform( const BSONObj& in ) const {
@@ -165,18 +155,15 @@ namespace mongo {
 
             switch(e.type()){
                 case Array:{
-                    BSONObjBuilder subb;
+                    BSONObjBuilder subb( b.subarrayStart( b.numStr(i++) ) );
                     appendArray(subb , e.embeddedObject(), true);
-                    b.appendArray(b.numStr(i++), subb.obj());
+                    subb.done();
                     break;
                 }
                 case Object:{
-                    BSONObjBuilder subb;
-                    BSONObjIterator jt(e.embeddedObject());
-                    while (jt.more()){
-                        append(subb , jt.next());
-                    }
-                    b.append(b.numStr(i++), subb.obj());
+                    BSONObjBuilder subb( b.subobjStart( b.numStr(i++) ) );
+                    appendFields(subb , e.embeddedObject(), false);
+                    subb.done();
                     break;
                 }
                 default:
@@ -186,34 +173,71 @@ namespace mongo {
         }
     }
 
-    void Projection::append( BSONObjBuilder& b , const BSONElement& e ) const {
+    Projection::ElementAction Projection::action( const BSONElement& e ) const {
         FieldMap::const_iterator field = _fields.find( e.fieldName() );
         
-        if (field == _fields.end()){
-            if (_include)
+        if (field == _fields.end())
+            return _include ? KEEP : DROP;
+
+        const Projection& subfm = *field->second;
+        if ((subfm._fields.empty() && !subfm._special) || !(e.type()==Object || e.type()==Array) )
+            return subfm._include ? KEEP : DROP;
+
+        return RECURSE;
+    }
+
+    void Projection::append( BSONObjBuilder& b , const BSONElement& e ) const {
+        switch ( action( e ) ){
+            case DROP:
+                return;
+            case KEEP:
                 b.append(e);
+                return;
+            case RECURSE:
+                break;
+        }
+
+        Projection& subfm = *_fields.find( e.fieldName() )->second;
+        if (e.type() == Object){ 
+            BSONObjBuilder subb( b.subobjStart( e.fieldName() ) );
+            subfm.appendFields(subb, e.embeddedObject(), false);
+            subb.done();
         } 
-        else {
-            Projection& subfm = *field->second;
-            
-            if ((subfm._fields.empty() && !subfm._special) || !(e.type()==Object || e.type()==Array) ){
-                if (subfm._include)
-                    b.append(e);
+        else { //Array
+            BSONObjBuilder subb( b.subarrayStart( e.fieldName() ) );
+            subfm.appendArray(subb, e.embeddedObject());
+            subb.done();
+        }
+    }
+
+    void Projection::appendFields( BSONObjBuilder& b , const BSONObj& o , bool topLevel ) const {
+        // start of the current run of elements being kept verbatim, or 0
+        const char *runStart = 0;
+        BSONObjIterator i(o);
+        while ( i.more() ){
+            BSONElement e = i.next();
+            ElementAction a;
+            if ( topLevel && mongoutils::str::equals( "_id" , e.fieldName() ) )
+                a = _includeID ? KEEP : DROP;
+            else
+                a = action( e );
+
+            if ( a == KEEP ){
+                if ( !runStart )
+                    runStart = e.rawdata();
+                continue;
             }
-            else if (e.type() == Object){ 
-                BSONObjBuilder subb;
-                BSONObjIterator it(e.embeddedObject());
-                while (it.more()){
-                    subfm.append(subb, it.next());
-                }
-                b.append(e.fieldName(), subb.obj());
 
-            } 
-            else { //Array
-                BSONObjBuilder subb;
-                subfm.appendArray(subb, e.embeddedObject());
-                b.appendArray(e.fieldName(), subb.obj());
+            if ( runStart ){
+                b.appendElementRun( runStart , e.rawdata() );
+                runStart = 0;
             }
+            if ( a == RECURSE )
+                append( b , e );
+        }
+        if ( runStart ){
+            // the run extends to the object's terminating eoo
+            b.appendElementRun( runStart , o.objdata() + o.objsize() - 1 );
         }
     }
 
@@ -96,12 +96,25 @@ namespace mongo {
         
     private:
 
+        enum ElementAction { DROP , KEEP , RECURSE };
+
+        /**
+         * @return whether e is dropped, kept verbatim, or must be descended into
+         */
+        ElementAction action( const BSONElement& e ) const;
+
         /**
          * appends e to b if user wants it
          * will descend into e if needed
          */
         void append( BSONObjBuilder& b , const BSONElement& e ) const;
 
+        /**
+         * appends the fields of o that user wants to b
+         * consecutive fields that are kept verbatim are copied with a single memcpy
+         */
+        void appendFields( BSONObjBuilder& b , const BSONObj& o , bool topLevel ) const;
+
 
         void add( const string& field, bool include );
         void add( const string& field, int skip, int limit );
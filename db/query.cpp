@@ -36,6 +36,8 @@
 #include "lasterror.h"
 #include "../s/d_logic.h"
 #include "repl_block.h"
+#include "../util/concurrency/thread_pool.h"
+#include "../util/timer.h"
 
 namespace mongo {
 
@@ -278,9 +280,12 @@ namespace mongo {
         ClientCursor *cc = p.c();
         
         int bufSize = 512;
+        int batchBytes = MaxBytesToReturnToClientAtOnce;
         if ( cc ){
+            /* awaitData comes back here with the same request, that isn't the client asking again */
+            batchBytes = pass == 0 ? cc->batchSizer.nextBatchBytes() : cc->batchSizer.batchBytes();
             bufSize += sizeof( QueryResult );
-            bufSize += MaxBytesToReturnToClientAtOnce;
+            bufSize += cc->batchSizer.bufferHint( ntoreturn );
         }
 
         BufBuilder b( bufSize );
@@ -316,6 +321,7 @@ namespace mongo {
             if ( cc->modifiedKeys() == false && cc->isMultiKey() == false && cc->fields )
                 keyFieldsOnly.reset( cc->fields->checkKey( cc->indexKeyPattern() ) );
 
+            Timer buildTime;
             while ( 1 ) {
                 if ( !c->ok() ) {
                     if ( c->tailable() ) {
@@ -365,7 +371,8 @@ namespace mongo {
                             fillQueryResultFromObj(b, cc->fields.get(), js, ( cc->pq.get() && cc->pq->showDiskLoc() ? &last : 0));
                         }
 
-                        if ( ( ntoreturn && n >= ntoreturn ) || b.len() > MaxBytesToReturnToClientAtOnce ){
+                        if ( ( ntoreturn && n >= ntoreturn ) || b.len() > batchBytes ||
+                             ( n % 16 == 0 && buildTime.micros() > ReplyBatchSizer::BuildMicros ) ){
                             c->advance();
                             cc->incPos( n );
                             break;
@@ -379,6 +386,7 @@ namespace mongo {
                 cc->updateLocation();
                 cc->mayUpgradeStorage();
                 cc->storeOpForSlave( last );
+                cc->batchSizer.sent( n , b.len() - (int) sizeof( QueryResult ) );
                 exhaust = cc->queryOptions() & QueryOption_Exhaust;
             }
         }
@@ -401,7 +409,8 @@ namespace mongo {
             _ns(ns), _capped(false), _count(), _myCount(),
             _skip( spec["skip"].numberLong() ),
             _limit( spec["limit"].numberLong() ),
-            _bc(){
+            _bc(),
+            _keysOnly(){
         }
         
         virtual void _init() {
@@ -412,6 +421,11 @@ namespace mongo {
                 _bc = dynamic_cast< BtreeCursor* >( _c.get() );
                 _bc->forgetEndKey();
             }
+            else if ( qp().indexed() && ! matcher()->needRecord() && ! qp().isMultiKey() &&
+                      boundsMatchQueryExactly( qp().originalQuery() ) ) {
+                // every key within the index bounds matches, so just count keys
+                _keysOnly = true;
+            }
         }
 
         virtual long long nscanned() {
@@ -463,6 +477,9 @@ namespace mongo {
                     _gotOne();
                 }
             } 
+            else if ( _keysOnly ) {
+                _gotOne();
+            }
             else {
                 if ( !matcher()->matches(_c->currKey(), _c->currLoc() ) ) {
                 }
@@ -511,11 +528,96 @@ namespace mongo {
         BSONObj _query;
         BtreeCursor * _bc;
         BSONObj _firstMatch;
+        bool _keysOnly;
 
         ClientCursor::CleanupPointer _cc;
         ClientCursor::YieldData _yieldData;
     };
 
+    /* Parallel count over a collection scan.
+
+       The extents of the collection are dealt round robin to cmdLine.parallelScan
+       workers, each with its own Matcher.  The calling thread holds the read lock
+       and does not yield until every worker is done, so the workers read records
+       directly (through their Extent, as they have no Client) without locking.
+    */
+    class ParallelCount : boost::noncopyable {
+    public:
+        // below this many records thread startup costs more than it saves
+        enum { MinRecords = 100000 };
+
+        ParallelCount( NamespaceDetails *d, const BSONObj &query, int nWorkers ) : 
+            _query( query ), _op( cc().curop() ), _counts( nWorkers ), _errors( nWorkers ) {
+            for( DiskLoc l = d->firstExtent; !l.isNull(); l = l.ext()->xnext )
+                _extents.push_back( l.ext() );
+        }
+
+        /** @return false if a worker failed, in which case the caller should count serially */
+        bool run( long long &count ) {
+            {
+                ThreadPool tp( _counts.size() );
+                for( unsigned i = 0; i < _counts.size(); ++i )
+                    tp.schedule( &ParallelCount::work, this, i );
+                tp.join();
+            }
+            killCurrentOp.checkForInterrupt();
+            count = 0;
+            for( unsigned i = 0; i < _counts.size(); ++i ) {
+                if ( !_errors[ i ].empty() ) {
+                    log() << "parallel count failed, counting serially: " << _errors[ i ] << endl;
+                    return false;
+                }
+                count += _counts[ i ];
+            }
+            return true;
+        }
+
+        /** @return true if the count of query on d may be run by ParallelCount */
+        static bool eligible( const char *ns, NamespaceDetails *d, const BSONObj &query ) {
+            if ( cmdLine.parallelScan < 2 || d->capped || d->stats.nrecords < MinRecords )
+                return false;
+            if ( !query["$or"].eoo() || Matcher( query ).hasWhere() )
+                return false;
+            // only worthwhile when the optimizer would scan the whole collection anyway
+            auto_ptr< FieldRangeSet > frs( new FieldRangeSet( ns, query ) );
+            auto_ptr< FieldRangeSet > origFrs( new FieldRangeSet( *frs ) );
+            QueryPlanSet qps( ns, frs, origFrs, query, BSONObj() );
+            return !qps.getBestGuess()->indexed();
+        }
+
+    private:
+        void work( unsigned worker ) {
+            try {
+                Matcher matcher( _query );
+                long long n = 0;
+                for( unsigned i = worker; i < _extents.size(); i += _counts.size() ) {
+                    Extent *e = _extents[ i ];
+                    for( DiskLoc l = e->firstRecord; !l.isNull(); ) {
+                        Record *r = e->getRecord( l );
+                        if ( matcher.matches( BSONObj( r ) ) )
+                            ++n;
+                        l = r->nextInExtent( l );
+                    }
+                    if ( killCurrentOp.globalInterruptCheck() || _op->killed() )
+                        break;
+                }
+                _counts[ worker ] = n;
+            }
+            catch( DBException &e ) {
+                _errors[ worker ] = e.toString();
+            }
+            catch( std::exception &e ) {
+                _errors[ worker ] = e.what();
+            }
+        }
+
+        BSONObj _query;
+        CurOp *_op;
+        vector< Extent* > _extents;
+        vector< long long > _counts;
+        vector< string > _errors;
+    };
+
     /* { count: "collectionname"[, query: <query>] }
        returns -1 on ns does not exist error.
     */    
@@ -532,6 +634,11 @@ namespace mongo {
         if ( query.isEmpty() ){
             return applySkipLimit( d->stats.nrecords , cmd );
         }
+        if ( ParallelCount::eligible( ns, d, query ) ) {
+            long long count;
+            if ( ParallelCount( d, query, cmdLine.parallelScan ).run( count ) )
+                return applySkipLimit( count , cmd );
+        }
         MultiPlanScanner mps( ns, query, BSONObj(), 0, true, BSONObj(), BSONObj(), false, true );
         CountOp original( ns , cmd );
         shared_ptr< CountOp > res = mps.runOp( original );
@@ -945,6 +1052,96 @@ namespace mongo {
         OpTime _slaveReadTill;
     };
     
+    /* QueryOption_DirectSend: the reply to a one batch query is written from the records themselves, in the
+       mapped data files, with no copy into a reply buffer.  the records can only be relied on while we hold
+       the read lock, so what the socket won't take right away is copied and sent once the lock is released.
+       @return false if the query can't be done this way, in which case nothing was sent.
+    */
+    static bool directSendQuery( Message& m, ParsedQuery& pq, CurOp& curop ) {
+        if ( pq.wantMore() || pq.isExplain() || pq.isSnapshot() || pq.returnKey() || pq.showDiskLoc() ||
+             pq.getFields() || pq.hasIndexSpecifier() || pq.getMaxScan() ||
+             pq.hasOption( QueryOption_CursorTailable | QueryOption_Exhaust ) )
+            return false;
+        const BSONObj& query = pq.getFilter();
+        if ( query.objsize() == 0 || ! query.getField( "$or" ).eoo() )
+            return false;
+        MessagingPort *port = cc()._mp;
+        if ( port == 0 || curop.parent() || port->getCompressor() ) // in process, or the client wants it compressed
+            return false;
+
+        const char *ns = pq.ns();
+        StringBuilder& ss = curop.debug().str;
+        BufBuilder header( sizeof( QueryResult ) );
+        header.skip( sizeof( QueryResult ) );
+        BufBuilder rest( 0 );
+        {
+            mongolock lk(false);
+            Client::Context ctx( ns , dbpath , &lk );
+            replVerifyReadsOk(pq);
+
+            shared_ptr<Cursor> c;
+            try {
+                c = bestGuessCursor( ns , query , pq.getOrder() );
+            }
+            catch ( MsgAssertionException& e ) {
+                if ( e.getCode() == 13284 ) // no index gives the order, it needs sorting
+                    return false;
+                throw;
+            }
+
+            vector< pair< char *, int > > data;
+            data.push_back( make_pair( header.buf() , header.len() ) );
+            int len = header.len();
+            int n = 0;
+            int skip = pq.getSkip();
+            while ( c->ok() ) {
+                if ( ( c->matcher() && ! c->matcher()->matchesCurrent( c.get() ) ) ||
+                     c->getsetdup( c->currLoc() ) ) {
+                    c->advance();
+                    continue;
+                }
+                if ( skip > 0 ) {
+                    skip--;
+                    c->advance();
+                    continue;
+                }
+                BSONObj o = c->current();
+                data.push_back( make_pair( (char *) o.objdata() , o.objsize() ) );
+                len += o.objsize();
+                n++;
+                if ( n >= pq.getNumToReturn() || len > MaxBytesToReturnToClientAtOnce )
+                    break;
+                c->advance();
+            }
+
+            QueryResult *qr = (QueryResult *) header.buf();
+            qr->len = len;
+            qr->id = nextMessageId();
+            qr->responseTo = m.header()->id;
+            qr->setOperation(opReply);
+            qr->setResultFlagsToOk();
+            qr->cursorId = 0;
+            qr->startingFrom = 0;
+            qr->nReturned = n;
+
+            int sent = port->sendNoWait( data , "query" );
+            for ( vector< pair< char *, int > >::const_iterator i = data.begin(); i != data.end(); ++i ) {
+                if ( sent >= i->second ) {
+                    sent -= i->second;
+                    continue;
+                }
+                rest.appendBuf( i->first + sent , i->second - sent );
+                sent = 0;
+            }
+
+            ss << " directSend reslen:" << len << " copied:" << rest.len() << " nreturned:" << n;
+        }
+
+        if ( rest.len() )
+            port->send( rest.buf() , rest.len() , "query" );
+        return true;
+    }
+
     /* run a query -- includes checking for and running a Command \
        @return points to ns if exhaust mode. 0=normal mode
     */
@@ -956,6 +1153,12 @@ namespace mongo {
         BSONObj jsobj = q.query;
         int queryOptions = q.queryOptions;
         const char *ns = q.ns;
+
+        if( ( queryOptions & QueryOption_Exhaust ) && ( queryOptions & QueryOption_CursorTailable ) ) {
+            /* nobody asks for the next batch of an exhaust stream, so a tailable one waits 
+               for data rather than sending empty batches as fast as it can */
+            queryOptions |= QueryOption_AwaitData;
+        }
         
         if( logLevel >= 2 )
             log() << "query: " << ns << jsobj << endl;
@@ -997,6 +1200,9 @@ namespace mongo {
         
         /* --- regular query --- */
 
+        if ( ( queryOptions & QueryOption_DirectSend ) && directSendQuery( m , pq , curop ) )
+            return 0; // the reply has been sent, result stays empty
+
         int n = 0;
         BSONElement hint = useHints ? pq.getHint() : BSONElement();
         bool explain = pq.isExplain();
@@ -1138,6 +1344,7 @@ namespace mongo {
             cc->pq = pq_shared;
             cc->fields = pq.getFieldPtr();
             cc->originalMessage = m;
+            cc->batchSizer.sent( n , result.header()->len - (int) sizeof( QueryResult ) );
             cc->updateLocation();
             if ( !cc->ok() && cc->c()->tailable() )
                 DEV tlog() << "query has no more but tailable, cursorid: " << cursorid << endl;
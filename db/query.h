@@ -225,9 +225,12 @@ namespace mongo {
             }
 
             
-            BSONElement e = q["query"];
+            const char *names[] = { "query", "$query" };
+            BSONElement fields[2];
+            q.getFields( 2, names, fields );
+            BSONElement e = fields[0];
             if ( ! e.isABSONObj() )
-                e = q["$query"];
+                e = fields[1];
             
             if ( e.isABSONObj() ){
                 _filter = e.embeddedObject();
@@ -65,6 +65,7 @@ namespace mongo {
         _direction( 0 ),
         _endKeyInclusive( endKey.isEmpty() ),
         _unhelpful( false ),
+        _skipScan( false ),
         _special( special ),
         _type(0),
         _startOrEndSpec( !startKey.isEmpty() || !endKey.isEmpty() ){
@@ -179,6 +180,17 @@ namespace mongo {
         if ( ( _scanAndOrderRequired || _order.isEmpty() ) &&
             !fbs.range( idxKey.firstElement().fieldName() ).nontrivial() ) {
             _unhelpful = true;
+            // If a later field of a compound index is constrained, the
+            // FieldRangeVector iterator can seek past each distinct value of
+            // the unconstrained prefix rather than scanning the whole index.
+            BSONObjIterator j( idxKey );
+            j.next();
+            while( j.more() ) {
+                if ( fbs.range( j.next().fieldName() ).nontrivial() ) {
+                    _skipScan = true;
+                    break;
+                }
+            }
         }
     }
     
@@ -460,7 +472,7 @@ namespace mongo {
             if ( p->optimal() ) {
                 addPlan( p, checkFirst );
                 return;
-            } else if ( !p->unhelpful() ) {
+            } else if ( !p->unhelpful() || p->skipScan() ) {
                 plans.push_back( p );
             }
         }
@@ -53,6 +53,9 @@ namespace mongo {
         /* If true, the startKey and endKey are unhelpful and the index order doesn't match the 
            requested sort order */
         bool unhelpful() const { return _unhelpful; }
+        /* If true, the leading index fields are unconstrained but a later field is not, so the
+           index may be scanned by seeking over each distinct value of the unconstrained prefix */
+        bool skipScan() const { return _skipScan; }
         int direction() const { return _direction; }
         shared_ptr<Cursor> newCursor( const DiskLoc &startLoc = DiskLoc() , int numWanted=0 ) const;
         shared_ptr<Cursor> newReverseCursor() const;
@@ -87,6 +90,7 @@ namespace mongo {
         BSONObj _endKey;
         bool _endKeyInclusive;
         bool _unhelpful;
+        bool _skipScan;
         string _special;
         IndexType * _type;
         bool _startOrEndSpec;
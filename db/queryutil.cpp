@@ -126,6 +126,117 @@ namespace mongo {
         ++regex[ regex.length() - 1 ];
         return regex;
     }    
+
+    string requiredRegexLiteral(const char* regex, const char* flags, bool* pureLiteral){
+        if (pureLiteral) *pureLiteral = false;
+
+        while (*flags){
+            switch (*(flags++)){
+                case 'i': // case insensitive
+                case 'x': // extended
+                    return "";
+                default:
+                    break;
+            }
+        }
+
+        // alternation anywhere means no single literal is required
+        if ( strchr( regex, '|' ) )
+            return "";
+
+        string best;
+        string run;
+        bool onlyLiterals = true;
+        while(*regex){
+            char c = *(regex++);
+            if ( c == '*' || c == '?' || c == '{' ){
+                // previous atom is optional (or '{' is a literal we don't bother with),
+                // strip it including any utf8 continuation bytes
+                while ( !run.empty() && ( run[ run.size() - 1 ] & 0xC0 ) == 0x80 )
+                    run.erase( run.size() - 1 );
+                if ( !run.empty() )
+                    run.erase( run.size() - 1 );
+                if ( run.size() > best.size() )
+                    best = run;
+                run = "";
+                onlyLiterals = false;
+                if ( c == '{' ){
+                    while( *regex && *regex != '}' )
+                        ++regex;
+                    if ( *regex )
+                        ++regex;
+                }
+            } else if ( c == '+' ){
+                // previous atom is required but may repeat
+                if ( run.size() > best.size() )
+                    best = run;
+                run = "";
+                onlyLiterals = false;
+            } else if ( c == '\\' ){
+                c = *(regex++);
+                if ( c == '\0' ){
+                    break;
+                } else if ( isalnum( c ) ){
+                    // single character classes and assertions are safe to step over,
+                    // anything else (\x41, \Q, backreferences) ends the scan
+                    if ( run.size() > best.size() )
+                        best = run;
+                    run = "";
+                    onlyLiterals = false;
+                    if ( !strchr( "dDwWsSbBAzZG", c ) )
+                        break;
+                } else {
+                    run += c;
+                }
+            } else if ( c == '[' || c == '(' ){
+                if ( run.size() > best.size() )
+                    best = run;
+                run = "";
+                onlyLiterals = false;
+                // inline options such as (?i) change how the rest of the pattern matches
+                if ( c == '(' && *regex == '?' )
+                    break;
+                // skip the class or group, honoring escapes and nesting
+                int depth = 1;
+                bool inClass = ( c == '[' );
+                if ( inClass && *regex == ']' )
+                    ++regex;
+                while( *regex && depth > 0 ){
+                    char d = *(regex++);
+                    if ( d == '\\' ){
+                        if ( *regex )
+                            ++regex;
+                    } else if ( inClass ){
+                        if ( d == ']' ){
+                            inClass = false;
+                            if ( c == '[' )
+                                --depth;
+                        }
+                    } else if ( d == '[' ){
+                        inClass = true;
+                        if ( *regex == ']' )
+                            ++regex;
+                    } else if ( d == '(' ){
+                        ++depth;
+                    } else if ( d == ')' ){
+                        --depth;
+                    }
+                }
+            } else if ( strchr( "^$.)", c ) ){
+                if ( run.size() > best.size() )
+                    best = run;
+                run = "";
+                onlyLiterals = false;
+            } else {
+                run += c;
+            }
+        }
+        if ( run.size() > best.size() )
+            best = run;
+
+        if ( pureLiteral ) *pureLiteral = onlyLiterals && !best.empty();
+        return best;
+    }
     
     
     FieldRange::FieldRange( const BSONElement &e, bool isNot, bool optimize ) {
@@ -1112,9 +1223,75 @@ namespace mongo {
     } simple_regex_unittest;
 
 
+    // values for which an equality interval and the matcher agree exactly
+    static bool exactBoundValue( const BSONElement &e ) {
+        switch( e.type() ) {
+            case NumberDouble:
+            case NumberInt:
+            case NumberLong:
+            case String:
+            case Bool:
+            case Date:
+            case jstOID:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    bool boundsMatchQueryExactly( const BSONObj &query ) {
+        BSONObjIterator i( query );
+        while( i.more() ) {
+            BSONElement e = i.next();
+            if ( e.fieldName()[ 0 ] == '$' )
+                return false;
+            if ( e.type() != Object || e.embeddedObject().firstElement().fieldName()[ 0 ] != '$' ) {
+                if ( !exactBoundValue( e ) )
+                    return false;
+                continue;
+            }
+            // all operands of range operators must share a type so the range optimization
+            // in FieldRange bounds them to that type, as the matcher does
+            int canonical = -1;
+            BSONObjIterator j( e.embeddedObject() );
+            while( j.more() ) {
+                BSONElement op = j.next();
+                switch( op.getGtLtOp( -1 ) ) {
+                    case BSONObj::LT:
+                    case BSONObj::LTE:
+                    case BSONObj::GT:
+                    case BSONObj::GTE:
+                        if ( !op.isNumber() && op.type() != String )
+                            return false;
+                        if ( canonical == -1 )
+                            canonical = op.canonicalType();
+                        else if ( canonical != op.canonicalType() )
+                            return false;
+                        break;
+                    case BSONObj::opIN: {
+                        if ( op.type() != Array )
+                            return false;
+                        BSONObjIterator k( op.embeddedObject() );
+                        while( k.more() ) {
+                            if ( !exactBoundValue( k.next() ) )
+                                return false;
+                        }
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+    
     long long applySkipLimit( long long num , const BSONObj& cmd ){
-        BSONElement s = cmd["skip"];
-        BSONElement l = cmd["limit"];
+        const char *names[] = { "skip", "limit" };
+        BSONElement fields[2];
+        cmd.getFields( 2, names, fields );
+        BSONElement s = fields[0];
+        BSONElement l = fields[1];
         
         if ( s.isNumber() ){
             num = num - s.numberLong();
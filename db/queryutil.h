@@ -547,6 +547,21 @@ namespace mongo {
     /** returns the upper bound of a query that matches prefix */
     string simpleRegexEnd( string prefix );
 
+    /** returns the longest literal substring that every string matching regex must contain,
+        or "" if none can be determined cheaply (alternation, case insensitivity, etc.)
+
+        if pureLiteral != NULL, sets it to whether matching regex is equivalent to a substring
+        search for the returned literal
+    */
+    string requiredRegexLiteral(const char* regex, const char* flags, bool* pureLiteral=NULL);
+
     long long applySkipLimit( long long num , const BSONObj& cmd );
 
+    /** @return true if the FieldRangeSet bounds generated for query select exactly the
+        documents query matches, so that scanning a non multikey index covering every field
+        of query within those bounds needs no further matching.  Conservative: only simple
+        equality, $in and type consistent $gt/$gte/$lt/$lte predicates qualify.
+    */
+    bool boundsMatchQueryExactly( const BSONObj &query );
+
 } // namespace mongo
@@ -379,6 +379,7 @@ namespace mongo {
             appendReplicationInfo( result , authed );
 
             result.appendNumber("maxBsonObjectSize", BSONObjMaxUserSize);
+            negotiateCompression( cmdObj , result , cc()._mp );
             return true;
         }
     } cmdismaster;
@@ -1485,6 +1486,7 @@ namespace mongo {
 
     bool OplogReader::connect(string hostName) {
         if( conn() == 0 ) {
+            _host = hostName;
             _conn = auto_ptr<DBClientConnection>(new DBClientConnection( false, 0, replPair ? 20 : 0 /* tcp timeout */));
             string errmsg;
             ReplInfo r("trying to connect to sync source");
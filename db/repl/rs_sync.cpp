@@ -71,7 +71,8 @@ namespace mongo {
                 BSONObjBuilder query;
                 query.append("ts", q.done());
                 BSONObj queryObj = query.done();
-                r.query(rsoplog, queryObj);
+                /* we read this to the end, so let the source stream it */
+                r.query(rsoplog, queryObj, QueryOption_Exhaust);
             }
             assert( r.haveCursor() );
 
@@ -102,7 +103,6 @@ namespace mongo {
                 }
             }
 
-            // todo : use exhaust
             unsigned long long n = 0;
             while( 1 ) { 
 
@@ -212,7 +212,8 @@ namespace mongo {
             }
         }
 
-        r.tailingQueryGTE(rsoplog, lastOpTimeWritten);
+        /* exhaust: the primary pushes new ops as they arrive instead of waiting for a getMore round trip per batch */
+        r.tailingQueryGTE(rsoplog, lastOpTimeWritten, QueryOption_Exhaust);
         assert( r.haveCursor() );
 
         uassert(1000, "replSet source for syncing doesn't seem to be await capable -- is it an older version of mongodb?", r.awaitCapable() );
@@ -221,6 +222,7 @@ namespace mongo {
             if( !r.more() ) {
                 /* maybe we are ahead and need to roll back? */
                 try {
+                    r.resetCursor(); // done with the stream, we query on this connection below
                     bo theirLastOp = r.getLastOp(rsoplog);
                     if( theirLastOp.isEmpty() ) {
                         log() << "replSet error empty query result from " << hn << " oplog" << rsLog;
@@ -258,6 +260,7 @@ namespace mongo {
             if( ts != lastOpTimeWritten || h != lastH ) { 
                 log() << "replSet our last op time written: " << lastOpTimeWritten.toStringPretty() << endl;
                 log() << "replset primary's GTE: " << ts.toStringPretty() << endl;
+                r.resetCursor(); // reconnects if need be, better outside rollback's write lock
                 syncRollback(r);
                 return;
             }
@@ -30,7 +30,10 @@ namespace mongo {
     
 	int AuthenticationInfo::warned = 0;
 
+    CredentialCache credentialCache;
+
     void AuthenticationInfo::print(){
+        scoped_lock lk(_lock);
         cout << "AuthenticationInfo: " << this << '\n';
         for ( map<string,Auth>::iterator i=m.begin(); i!=m.end(); i++ ){
             cout << "\t" << i->first << "\t" << i->second.level << '\n';
@@ -39,17 +42,28 @@ namespace mongo {
     }
 
 
+    void AuthenticationInfo::_updateAdminLevel() {
+        map<string, Auth>::const_iterator a = m.find("admin");
+        map<string, Auth>::const_iterator l = m.find("local");
+        _adminLevel = max( a == m.end() ? 0 : a->second.level , l == m.end() ? 0 : l->second.level );
+    }
+
     bool AuthenticationInfo::_isAuthorizedSpecialChecks( const string& dbname ) {
         if ( cc().isGod() ){
             return true;
         }
         
         if ( isLocalHost ){
-            atleastreadlock l(""); 
-            Client::GodScope gs;
-            Client::Context c("admin.system.users");
-            BSONObj result;
-            if( ! Helpers::getSingleton("admin.system.users", result) ){
+            int any = credentialCache.adminUsers();
+            if ( any < 0 ) {
+                atleastreadlock l(""); 
+                Client::GodScope gs;
+                Client::Context c("admin.system.users");
+                BSONObj result;
+                any = Helpers::getSingleton("admin.system.users", result) ? 1 : 0;
+                credentialCache.setAdminUsers( any );
+            }
+            if( any == 0 ){
                 if( warned == 0 ) {
                     warned++;
                     log() << "note: no users configured in admin.system.users, allowing localhost access" << endl;
@@ -60,5 +74,33 @@ namespace mongo {
         return false;
     }
 
+    bool CredentialCache::get( const string& db , const string& user , Credentials& c ) {
+        scoped_lock lk( _mutex );
+        map< string , map< string , Credentials > >::const_iterator i = _dbs.find( db );
+        if ( i == _dbs.end() )
+            return false;
+        map< string , Credentials >::const_iterator j = i->second.find( user );
+        if ( j == i->second.end() )
+            return false;
+        c = j->second;
+        return true;
+    }
+
+    void CredentialCache::set( const string& db , const string& user , const Credentials& c ) {
+        scoped_lock lk( _mutex );
+        _dbs[db][user] = c;
+    }
+
+    void CredentialCache::invalidate( const string& db ) {
+        scoped_lock lk( _mutex );
+        _dbs.erase( db );
+        if ( db == "admin" )
+            _adminUsers = -1;
+    }
+
+    void CredentialCache::_noteWrite( const char *ns ) {
+        invalidate( nsToDatabase( ns ) );
+    }
+
 } // namespace mongo
 
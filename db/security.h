@@ -35,23 +35,27 @@ namespace mongo {
     class AuthenticationInfo : boost::noncopyable {
         mongo::mutex _lock;
         map<string, Auth> m; // dbname -> auth
+        int _adminLevel; // highest level on admin or local, which count for every db
 		static int warned;
     public:
 		bool isLocalHost;
-        AuthenticationInfo() : _lock("AuthenticationInfo") { isLocalHost = false; }
+        AuthenticationInfo() : _lock("AuthenticationInfo"), _adminLevel(0) { isLocalHost = false; }
         ~AuthenticationInfo() {
         }
         void logout(const string& dbname ) { 
             scoped_lock lk(_lock);
 			m.erase(dbname); 
+            _updateAdminLevel();
 		}
         void authorize(const string& dbname ) { 
             scoped_lock lk(_lock);
             m[dbname].level = 2;
+            _updateAdminLevel();
         }
         void authorizeReadOnly(const string& dbname) {
             scoped_lock lk(_lock);
             m[dbname].level = 1;            
+            _updateAdminLevel();
         }
         bool isAuthorized(const string& dbname) { return _isAuthorized( dbname, 2 ); }
         bool isAuthorizedReads(const string& dbname) { return _isAuthorized( dbname, 1 ); }
@@ -60,15 +64,60 @@ namespace mongo {
         void print();
 
     protected:
+        /* on the request path, so no lock: m only changes on the connection's own thread, 
+           which is the one asking.  _lock is for anyone else looking (print). 
+        */
         bool _isAuthorized(const string& dbname, int level) { 
-            if( m[dbname].level >= level ) return true;
 			if( noauth ) return true;
-			if( m["admin"].level >= level ) return true;
-			if( m["local"].level >= level ) return true;
+            if( _adminLevel >= level ) return true;
+            map<string, Auth>::const_iterator i = m.find(dbname);
+            if( i != m.end() && i->second.level >= level ) return true;
             return _isAuthorizedSpecialChecks( dbname );
         }
 
         bool _isAuthorizedSpecialChecks( const string& dbname );
+        void _updateAdminLevel();
     };
 
+    /**
+     * system.users entries by db and user, so authenticate needs neither a lock nor a query
+     * for users it has seen before.  a db's entries are dropped whenever its system.users 
+     * changes; filling happens under the db lock, so a stale entry can't be put back.
+     */
+    class CredentialCache : boost::noncopyable {
+    public:
+        struct Credentials {
+            string pwd; // digest as stored in system.users
+            bool readOnly;
+        };
+
+        CredentialCache() : _mutex("CredentialCache"), _adminUsers(-1) { }
+
+        /** @return false if we don't have user for db */
+        bool get( const string& db , const string& user , Credentials& c );
+        /** call with the db lock held, from the read of system.users that c came from */
+        void set( const string& db , const string& user , const Credentials& c );
+
+        /** -1 not known, 0 admin.system.users is empty, 1 it isn't */
+        int adminUsers() const { return _adminUsers; }
+        /** call with the db lock held, as for set() */
+        void setAdminUsers( bool any ) { _adminUsers = any ? 1 : 0; }
+
+        /** ns is about to change.  cheap unless it is a system.users */
+        void noteWrite( const char *ns ) {
+            if ( strstr( ns , ".system.users" ) )
+                _noteWrite( ns );
+        }
+        void invalidate( const string& db );
+
+    private:
+        void _noteWrite( const char *ns );
+
+        mongo::mutex _mutex;
+        map< string , map< string , Credentials > > _dbs;
+        volatile int _adminUsers;
+    };
+
+    extern CredentialCache credentialCache;
+
 } // namespace mongo
@@ -93,7 +93,8 @@ namespace mongo {
         virtual bool slaveOk() const {
             return true;
         }
-        virtual LockType locktype() const { return WRITE; }
+        /* locks only to read system.users for a user not in credentialCache */
+        virtual LockType locktype() const { return NONE; }
         virtual void help(stringstream& ss) const { ss << "internal"; }
         CmdAuthenticate() : Command("authenticate") {}
         bool run(const string& dbname , BSONObj& cmdObj, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
@@ -127,19 +128,23 @@ namespace mongo {
                 }
                     
                 if ( reject ) {
-                    log() << "auth: bad nonce received or getnonce not called. could be a driver bug or a security attack. db:" << cc().database()->name << endl;
+                    log() << "auth: bad nonce received or getnonce not called. could be a driver bug or a security attack. db:" << dbname << endl;
                     errmsg = "auth fails";
                     sleepmillis(30);
                     return false;
                 }
             }
 
-            static BSONObj userPattern = fromjson("{\"user\":1}");
-            string systemUsers = dbname + ".system.users";
-            OCCASIONALLY Helpers::ensureIndex(systemUsers.c_str(), userPattern, false, "user_1");
+            CredentialCache::Credentials cred;
+            if ( ! credentialCache.get( dbname , user , cred ) ) {
+                static BSONObj userPattern = fromjson("{\"user\":1}");
+                string systemUsers = dbname + ".system.users";
 
-            BSONObj userObj;
-            {
+                writelock lk( systemUsers );
+                Client::Context ctx( systemUsers , dbpath , 0 , false );
+                OCCASIONALLY Helpers::ensureIndex(systemUsers.c_str(), userPattern, false, "user_1");
+
+                BSONObj userObj;
                 BSONObjBuilder b;
                 b << "user" << user;
                 BSONObj query = b.done();
@@ -148,13 +153,15 @@ namespace mongo {
                     errmsg = "auth fails";
                     return false;
                 }
+
+                cred.pwd = userObj.getStringField("pwd");
+                cred.readOnly = userObj[ "readOnly" ].isBoolean() && userObj[ "readOnly" ].boolean();
+                credentialCache.set( dbname , user , cred );
             }
             
             md5digest d;
             {
-                
-                string pwd = userObj.getStringField("pwd");
-                digestBuilder << user << pwd;
+                digestBuilder << user << cred.pwd;
                 string done = digestBuilder.str();
                 
                 md5_state_t st;
@@ -173,10 +180,10 @@ namespace mongo {
 
             AuthenticationInfo *ai = cc().getAuthenticationInfo();
             
-            if ( userObj[ "readOnly" ].isBoolean() && userObj[ "readOnly" ].boolean() ) {
-                ai->authorizeReadOnly( cc().database()->name.c_str() );
+            if ( cred.readOnly ) {
+                ai->authorizeReadOnly( dbname );
             } else {
-                ai->authorize( cc().database()->name.c_str() );
+                ai->authorize( dbname );
             }
             return true;
         }
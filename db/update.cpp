@@ -24,6 +24,7 @@
 #include "repl.h"
 #include "update.h"
 #include "btree.h"
+#include "security.h"
 
 //#define DEBUGUPDATE(x) cout << x << endl;
 #define DEBUGUPDATE(x)
@@ -974,6 +975,7 @@ namespace mongo {
             auto_ptr<ModSetState> mss = mods->prepare( onDisk );
                     
             if( mss->canApplyInPlace() ) {
+                credentialCache.noteWrite( ns );
                 mss->applyModsInPlace(true);
                 DEBUGUPDATE( "\t\t\t updateById doing in place update" );
                 /*if ( profile )
@@ -1026,6 +1028,18 @@ namespace mongo {
         return UpdateResult( 1 , 0 , 1 );
     }
  
+    /** make a multi-update's batched index changes, keeping the cursor's place in any index they touch */
+    static void flushIndexUpdates( IndexUpdateBatch *batch, Cursor *c, ClientCursor *cc ) {
+        if ( batch == 0 || batch->empty() )
+            return;
+        if ( cc )
+            cc->updateLocation();
+        else
+            c->noteLocation();
+        batch->apply();
+        c->checkLocation();
+    }
+
     UpdateResult _updateObjects(bool god, const char *ns, const BSONObj& updateobj, BSONObj patternOrig, bool upsert, bool multi, bool logop , OpDebug& debug, RemoveSaver* rs ) {
         DEBUGUPDATE( "update: " << ns << " update: " << updateobj << " query: " << patternOrig << " upsert: " << upsert << " multi: " << multi );
         Client& client = cc();
@@ -1073,6 +1087,14 @@ namespace mongo {
         shared_ptr< MultiCursor > c( new MultiCursor( ns, patternOrig, BSONObj(), opPtr, true ) );
         
         auto_ptr<ClientCursor> cc;
+
+        /* a multi-update that changes indexed fields leaves index changes for records it updates in
+           place in batch, and makes them at each yield point -- per index, in key order.  seenObjects
+           keeps the cursor from acting on the stale entries in between.
+        */
+        auto_ptr<IndexUpdateBatch> batch;
+        if ( multi && modsIsIndexed > 0 && d )
+            batch.reset( new IndexUpdateBatch( d ) );
             
         while ( c->ok() ) {
             nscanned++;
@@ -1084,6 +1106,7 @@ namespace mongo {
                 c->advance();
                     
                 if ( nscanned % 256 == 0 && ! atomic ){
+                    flushIndexUpdates( batch.get(), c.get(), cc.get() );
                     if ( cc.get() == 0 ) {
                         shared_ptr< Cursor > cPtr = c;
                         cc.reset( new ClientCursor( QueryOption_NoCursorTimeout , cPtr , ns ) );
@@ -1166,6 +1189,7 @@ namespace mongo {
                 }
                     
                 if ( modsIsIndexed <= 0 && mss->canApplyInPlace() ){
+                    credentialCache.noteWrite( ns );
                     mss->applyModsInPlace( true );// const_cast<BSONObj&>(onDisk) );
                     
                     DEBUGUPDATE( "\t\t\t doing in place update" );
@@ -1183,7 +1207,7 @@ namespace mongo {
                     BSONObj newObj = mss->createNewFromMods();
                     checkTooLarge(newObj);
                     bool changedId;
-                    DiskLoc newLoc = theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , newObj.objdata(), newObj.objsize(), debug, changedId);
+                    DiskLoc newLoc = theDataFileMgr.updateRecord(ns, d, nsdt, r, loc , newObj.objdata(), newObj.objsize(), debug, changedId, false, batch.get());
                     if ( newLoc != loc || modsIsIndexed ) {
                         // object moved, need to make sure we don' get again
                         seenObjects.insert( newLoc );
@@ -1216,6 +1240,7 @@ namespace mongo {
                     c->checkLocation();
                     
                 if ( nscanned % 64 == 0 && ! atomic ){
+                    flushIndexUpdates( batch.get(), c.get(), cc.get() );
                     if ( cc.get() == 0 ) {
                         shared_ptr< Cursor > cPtr = c;
                         cc.reset( new ClientCursor( QueryOption_NoCursorTimeout , cPtr , ns ) );
@@ -1228,6 +1253,9 @@ namespace mongo {
                         break;
                     }
                 }
+                else if ( batch.get() && batch->full() ) {
+                    flushIndexUpdates( batch.get(), c.get(), cc.get() );
+                }
                 
                 continue;
             } 
@@ -1250,6 +1278,9 @@ namespace mongo {
             return UpdateResult( 1 , 0 , 1 );
         }
         
+        if ( batch.get() )
+            batch->apply();
+
         if ( numModded )
             return UpdateResult( 1 , 1 , numModded );
 
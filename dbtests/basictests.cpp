@@ -21,6 +21,7 @@
 
 #include "dbtests.h"
 #include "../util/base64.h"
+#include "../util/compress.h"
 #include "../util/array.h"
 #include "../util/text.h"
 #include "../util/queue.h"
@@ -114,6 +115,52 @@ namespace BasicTests {
         }
     };
 
+    class CompressTests {
+    public:
+
+        int roundTrip( const string& s ){
+            string out( maxCompressedLength( s.size() ) , 0 );
+            int len = compressBlock( s.data() , s.size() , &out[0] );
+            ASSERT( len <= maxCompressedLength( s.size() ) );
+
+            string back( s.size() , 0 );
+            ASSERT( decompressBlock( out.data() , len , &back[0] , back.size() ) );
+            ASSERT( s == back );
+
+            // the wrong size isn't accepted
+            string wrong( s.size() + 1 , 0 );
+            ASSERT( ! decompressBlock( out.data() , len , &wrong[0] , wrong.size() ) );
+            return len;
+        }
+
+        void run(){
+            roundTrip( "" );
+            roundTrip( "a" );
+            roundTrip( "abcd" );
+            roundTrip( "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa" );
+
+            // a reply batch
+            BufBuilder b;
+            for ( int i=0; i<1000; i++ ){
+                BSONObj o = BSON( "_id" << i << "name" << "something" << "tags" << BSON_ARRAY( "a" << "b" ) );
+                b.appendBuf( o.objdata() , o.objsize() );
+            }
+            string batch( b.buf() , b.len() );
+            ASSERT( roundTrip( batch ) < (int)batch.size() / 4 );
+
+            // incompressible
+            string r;
+            for ( int i=0; i<10000; i++ )
+                r += (char)( rand() & 0xff );
+            roundTrip( r );
+
+            // a match before the start of the output
+            const char bad[] = { 0x04 , 0x01 , 0x00 };
+            char out[8];
+            ASSERT( ! decompressBlock( bad , 3 , out , 8 ) );
+        }
+    };
+
     namespace stringbuildertests {
 #define SBTGB(x) ss << (x); sb << (x);
         
@@ -535,6 +582,7 @@ namespace BasicTests {
         void setupTests(){
             add< Rarely >();
             add< Base64Tests >();
+            add< CompressTests >();
             
             add< stringbuildertests::simple1 >();
             add< stringbuildertests::simple2 >();
@@ -38,6 +38,43 @@ namespace JsobjTests {
         }
     };
 
+    class BufBuilderPooled {
+    public:
+        void run() {
+            BSONObj escaped;
+            {
+                BufBuilderPool pool;
+                _pool = &pool;
+                BufBuilderPool::setCurrentFn( current );
+                char *first;
+                {
+                    BufBuilder b;
+                    first = b.buf();
+                    b.appendStr( "foo" );
+                }
+                {
+                    // reuses the buffer the first builder gave back
+                    BufBuilder b;
+                    ASSERT( first == b.buf() );
+                    BufBuilder other;
+                    ASSERT( first != other.buf() );
+                }
+                {
+                    BSONObjBuilder b;
+                    b.append( "a", 1 );
+                    escaped = b.obj();
+                }
+                _pool = 0;
+            }
+            // obj() took the buffer out of the pool's reach, so it outlives the pool
+            ASSERT_EQUALS( 1, escaped[ "a" ].numberInt() );
+        }
+    private:
+        static BufBuilderPool *_pool;
+        static BufBuilderPool* current() { return _pool; }
+    };
+    BufBuilderPool *BufBuilderPooled::_pool = 0;
+
     class BSONElementBasic {
     public:
         void run() {
@@ -193,6 +230,29 @@ namespace JsobjTests {
             }
         };
 
+        class GetFields {
+        public:
+            void run() {
+                BSONObj o = fromjson( "{ab:1,a:2,b:{c:3},'a.x':4,abc:5,a:6}" );
+                ASSERT_EQUALS( 2, o.getField( "a" ).numberInt() );
+                ASSERT_EQUALS( 1, o.getField( "ab" ).numberInt() );
+                ASSERT( o.getField( "abcd" ).eoo() );
+                ASSERT( o.getField( "" ).eoo() );
+                ASSERT_EQUALS( 4, o.getFieldDotted( "a.x" ).numberInt() );
+                ASSERT_EQUALS( 3, o.getFieldDotted( "b.c" ).numberInt() );
+                ASSERT( o.getFieldDotted( "ab.c" ).eoo() );
+                ASSERT( o.getFieldDotted( "b.c.d" ).eoo() );
+
+                const char *names[] = { "abc", "a", "z", "b" };
+                BSONElement fields[4];
+                o.getFields( 4, names, fields );
+                ASSERT_EQUALS( 5, fields[0].numberInt() );
+                ASSERT_EQUALS( 2, fields[1].numberInt() );
+                ASSERT( fields[2].eoo() );
+                ASSERT_EQUALS( Object, fields[3].type() );
+            }
+        };
+
         class TimestampTest : public Base {
         public:
             void run() {
@@ -1746,6 +1806,7 @@ namespace JsobjTests {
 
         void setupTests(){
             add< BufBuilderBasic >();
+            add< BufBuilderPooled >();
             add< BSONElementBasic >();
             add< BSONObjTests::Create >();
             add< BSONObjTests::WoCompareBasic >();
@@ -1756,6 +1817,7 @@ namespace JsobjTests {
             add< BSONObjTests::WoCompareDifferentLength >();
             add< BSONObjTests::WoSortOrder >();
             add< BSONObjTests::MultiKeySortOrder > ();
+            add< BSONObjTests::GetFields >();
             add< BSONObjTests::TimestampTest >();
             add< BSONObjTests::Nan >();
             add< BSONObjTests::AsTempObj >();
@@ -357,6 +357,19 @@ namespace JsonTests {
             }
         };
 
+        class AppendToBuilder {
+        public:
+            void run() {
+                StringBuilder s;
+                s << "[ ";
+                BSON( "a" << 1 << "b" << -2.5 ).jsonString( s );
+                s << ", ";
+                BSON( "c" << 12321312312LL ).firstElement().jsonString( s, Strict, false );
+                s << " ]";
+                ASSERT_EQUALS( "[ { \"a\" : 1, \"b\" : -2.5 }, 12321312312 ]", s.str() );
+            }
+        };
+
         class AllTypes {
         public:
             void run(){
@@ -1078,6 +1091,22 @@ namespace JsonTests {
             }
         };
 
+        /** with a length out param, parse one object and report how much input it used */
+        class Streamed {
+        public:
+            void run() {
+                const char *json = "{ \"a\" : 1 }  { \"b\" : [ 2 ] }\n";
+                int len = -1;
+                BSONObj a = fromjson( json, &len );
+                ASSERT_EQUALS( BSON( "a" << 1 ), a );
+                ASSERT_EQUALS( 13, len );
+                BSONObj b = fromjson( json + len, &len );
+                ASSERT_EQUALS( BSON( "b" << BSON_ARRAY( 2 ) ), b );
+                ASSERT_EQUALS( 16, len );
+                ASSERT_EXCEPTION( fromjson( json ), MsgAssertionException );
+            }
+        };
+
     } // namespace FromJsonTests
 
     class All : public Suite {
@@ -1115,6 +1144,7 @@ namespace JsonTests {
             add< JsonStringTests::CodeTests >();
             add< JsonStringTests::TimestampTests >();
             add< JsonStringTests::NullString >();
+            add< JsonStringTests::AppendToBuilder >();
             add< JsonStringTests::AllTypes >();
             
             add< FromJsonTests::Empty >();
@@ -1168,6 +1198,7 @@ namespace JsonTests {
             add< FromJsonTests::EmbeddedDatesFormat2 >();
             add< FromJsonTests::EmbeddedDatesFormat3 >();
             add< FromJsonTests::NullString >();
+            add< FromJsonTests::Streamed >();
         }
     } myall;
 
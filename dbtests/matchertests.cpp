@@ -116,6 +116,23 @@ namespace MatcherTests {
         }        
     };
     
+    class RegexLiteral {
+    public:
+        void run() {
+            Matcher m( fromjson( "{a:/foo/}" ) );
+            ASSERT( m.matches( fromjson( "{a:'xfooy'}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:'xfoy'}" ) ) );
+            Matcher m2( fromjson( "{a:/fo+ba.r/}" ) );
+            ASSERT( m2.matches( fromjson( "{a:'foooobazr'}" ) ) );
+            ASSERT( !m2.matches( fromjson( "{a:'foooobar'}" ) ) );
+            ASSERT( !m2.matches( fromjson( "{a:'oobazr'}" ) ) );
+            Matcher m3( fromjson( "{a:/FOO/i}" ) );
+            ASSERT( m3.matches( fromjson( "{a:'xfooy'}" ) ) );
+            Matcher m4( fromjson( "{a:{$in:[/ab?c/]}}" ) );
+            ASSERT( m4.matches( fromjson( "{a:'xacx'}" ) ) );
+            ASSERT( !m4.matches( fromjson( "{a:'xbcx'}" ) ) );
+        }
+    };
 
     class All : public Suite {
     public:
@@ -130,6 +147,7 @@ namespace MatcherTests {
             add< MixedNumericIN >();
             add< Size >();
             add< MixedNumericEmbedded >();
+            add< RegexLiteral >();
         }
     } dball;
     
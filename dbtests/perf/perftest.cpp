@@ -330,6 +330,56 @@ namespace BSON {
         BSONObj o_;
     };
 
+    class ShopwikiJsonBuffer {
+    public:
+        ShopwikiJsonBuffer() : o_( fromjson( shopwikiSample ) ) {}
+        void run() {
+            StringBuilder s;
+            for( int i = 0; i < 10000; ++i ) {
+                s.reset();
+                o_.jsonString( s );
+            }
+        }
+        BSONObj o_;
+    };
+
+    class ShopwikiValid {
+    public:
+        ShopwikiValid() : o_( fromjson( shopwikiSample ) ) {}
+        void run() {
+            for( int i = 0; i < 100000; ++i )
+                ASSERT( o_.valid() );
+        }
+        BSONObj o_;
+    };
+
+    class ShopwikiGetField {
+    public:
+        ShopwikiGetField() : o_( fromjson( shopwikiSample ) ) {}
+        void run() {
+            for( int i = 0; i < 100000; ++i ) {
+                o_.getField( "url_hash" );
+                o_.getField( "last_update" );
+                o_.getFieldDotted( "features.Brand" );
+                o_.getField( "missing" );
+            }
+        }
+        BSONObj o_;
+    };
+
+    class ShopwikiGetFields {
+    public:
+        ShopwikiGetFields() : o_( fromjson( shopwikiSample ) ) {}
+        void run() {
+            const char *names[] = { "url_hash", "last_update", "features", "missing" };
+            for( int i = 0; i < 100000; ++i ) {
+                BSONElement fields[4];
+                o_.getFields( 4, names, fields );
+            }
+        }
+        BSONObj o_;
+    };
+
     class All : public RunnerSuite {
     public:
         All() : RunnerSuite( "bson" ){}
@@ -338,6 +388,10 @@ namespace BSON {
             add< ShopwikiParse >();
             add< Json >();
             add< ShopwikiJson >();
+            add< ShopwikiJsonBuffer >();
+            add< ShopwikiValid >();
+            add< ShopwikiGetField >();
+            add< ShopwikiGetFields >();
         }
     } all;
 
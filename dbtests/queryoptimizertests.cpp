@@ -1011,6 +1011,20 @@ namespace QueryOptimizerTests {
             }
         };
         
+        class SkipScan : public Base {
+        public:
+            void run() {
+                QueryPlan p( nsd(), INDEXNO( "a" << 1 << "b" << 1 ), FBS( BSON( "b" << 1 ) ), FBS2( BSON( "b" << 1 ) ), BSON( "b" << 1 ), BSONObj() );
+                ASSERT( p.skipScan() );
+                QueryPlan p2( nsd(), INDEXNO( "a" << 1 << "b" << 1 ), FBS( BSON( "a" << 1 << "b" << 1 ) ), FBS2( BSON( "a" << 1 << "b" << 1 ) ), BSON( "a" << 1 << "b" << 1 ), BSONObj() );
+                ASSERT( !p2.skipScan() );
+                QueryPlan p3( nsd(), INDEXNO( "b" << 1 ), FBS( BSON( "c" << 1 ) ), FBS2( BSON( "c" << 1 ) ), BSON( "c" << 1 ), BSONObj() );
+                ASSERT( !p3.skipScan() );
+                QueryPlan p4( nsd(), INDEXNO( "b" << 1 << "c" << 1 ), FBS( BSON( "c" << 1 << "d" << 1 ) ), FBS2( BSON( "c" << 1 << "d" << 1 ) ), BSON( "c" << 1 << "d" << 1 ), BSONObj() );
+                ASSERT( p4.skipScan() );
+            }
+        };
+        
     } // namespace QueryPlanTests
 
     namespace QueryPlanSetTests {
@@ -1215,6 +1229,32 @@ namespace QueryOptimizerTests {
             }
         };        
         
+        class SkipScanIndex : public Base {
+        public:
+            void run() {
+                Helpers::ensureIndex( ns(), BSON( "a" << 1 << "b" << 1 ), false, "a_1_b_1" );
+                for( int i = 0; i < 10; ++i ) {
+                    for( int j = 0; j < 10; ++j ) {
+                        BSONObj o = BSON( "a" << i << "b" << j );
+                        theDataFileMgr.insertWithObjMod( ns(), o );
+                    }
+                }
+                auto_ptr< FieldRangeSet > frs( new FieldRangeSet( ns(), BSON( "b" << 5 ) ) );
+                auto_ptr< FieldRangeSet > frsOrig( new FieldRangeSet( *frs ) );
+                QueryPlanSet s( ns(), frs, frsOrig, BSON( "b" << 5 ), BSONObj() );
+                ASSERT_EQUALS( 2, s.nPlans() );
+                shared_ptr< Cursor > c = s.getBestGuess()->newCursor();
+                int count = 0;
+                for( ; c->ok(); c->advance() ) {
+                    ASSERT_EQUALS( 5, c->current()[ "b" ].number() );
+                    ++count;
+                }
+                ASSERT_EQUALS( 10, count );
+                // one seek per distinct value of 'a', rather than every key
+                ASSERT( c->nscanned() < 100 );
+            }
+        };
+        
         class SingleException : public Base {
         public:
             void run() {
@@ -1753,6 +1793,7 @@ namespace QueryOptimizerTests {
             add< QueryPlanTests::MoreKeyMatch >();
             add< QueryPlanTests::ExactKeyQueryTypes >();
             add< QueryPlanTests::Unhelpful >();
+            add< QueryPlanTests::SkipScan >();
             add< QueryPlanSetTests::NoIndexes >();
             add< QueryPlanSetTests::Optimal >();
             add< QueryPlanSetTests::NoOptimal >();
@@ -1765,6 +1806,7 @@ namespace QueryOptimizerTests {
             add< QueryPlanSetTests::Count >();
             add< QueryPlanSetTests::QueryMissingNs >();
             add< QueryPlanSetTests::UnhelpfulIndex >();
+            add< QueryPlanSetTests::SkipScanIndex >();
             add< QueryPlanSetTests::SingleException >();
             add< QueryPlanSetTests::AllException >();
             add< QueryPlanSetTests::SaveGoodIndex >();
@@ -24,6 +24,7 @@
 #include "../db/instance.h"
 #include "../db/json.h"
 #include "../db/lasterror.h"
+#include "../db/security.h"
 
 #include "../util/timer.h"
 
@@ -132,6 +133,30 @@ namespace QueryTests {
         }
     };
     
+    class CountIndexedRange : public Base {
+    public:
+        void run() {
+            insert( "{a:1}" );
+            insert( "{a:2}" );
+            insert( "{a:3}" );
+            insert( "{a:'x'}" );
+            insert( "{a:4,b:1}" );
+            string err;
+            ASSERT_EQUALS( 2, runCount( ns(), fromjson( "{query:{a:{$gt:1,$lte:3}}}" ), err ) );
+            ASSERT_EQUALS( 3, runCount( ns(), fromjson( "{query:{a:{$gt:1}}}" ), err ) );
+            ASSERT_EQUALS( 3, runCount( ns(), fromjson( "{query:{a:{$in:[1,3,'x']}}}" ), err ) );
+            ASSERT_EQUALS( 1, runCount( ns(), fromjson( "{query:{a:{$gt:1},b:1}}" ), err ) );
+            
+            ASSERT( boundsMatchQueryExactly( fromjson( "{a:{$gt:1,$lte:3}}" ) ) );
+            ASSERT( boundsMatchQueryExactly( fromjson( "{a:'x',b:{$in:[1,2]}}" ) ) );
+            ASSERT( !boundsMatchQueryExactly( fromjson( "{a:{$gt:1,$lte:'z'}}" ) ) );
+            ASSERT( !boundsMatchQueryExactly( fromjson( "{a:{$ne:1}}" ) ) );
+            ASSERT( !boundsMatchQueryExactly( fromjson( "{a:/^b/}" ) ) );
+            ASSERT( !boundsMatchQueryExactly( fromjson( "{a:null}" ) ) );
+            ASSERT( !boundsMatchQueryExactly( fromjson( "{$or:[{a:1}]}" ) ) );
+        }
+    };
+    
     class FindOne : public Base {
     public:
         void run() {
@@ -228,6 +253,97 @@ namespace QueryTests {
         }
     };
 
+    class ExhaustFallback : public ClientBase {
+    public:
+        const char* ns;
+        ExhaustFallback() : ns("unittests.querytests.ExhaustFallback") {}
+        ~ExhaustFallback() {
+            client().dropCollection( ns );
+        }
+        void run() {
+            for(int i=0; i<150; i++)
+                insert( ns, BSON( GENOID << "i" << i ) );
+
+            // DBDirectClient can't stream, so the cursor falls back to getMore
+            ASSERT_EQUALS( client().query( ns, BSONObj(), 0, 0, 0, QueryOption_Exhaust, 10 )->itcount(), 150 );
+            // nor does exhaust honor a limit
+            ASSERT_EQUALS( client().query( ns, BSONObj(), 20, 0, 0, QueryOption_Exhaust )->itcount(), 20 );
+        }
+    };
+
+    class DirectSendFallback : public ClientBase {
+    public:
+        const char* ns;
+        DirectSendFallback() : ns("unittests.querytests.DirectSendFallback") {}
+        ~DirectSendFallback() {
+            client().dropCollection( ns );
+        }
+        void run() {
+            client().ensureIndex( ns, BSON( "files_id" << 1 << "n" << 1 ) );
+            for(int i=0; i<10; i++)
+                insert( ns, BSON( "files_id" << 1 << "n" << 9 - i ) );
+
+            // DBDirectClient has no socket to write to, so this is an ordinary reply
+            auto_ptr< DBClientCursor > c = client().query( ns, Query( BSON( "files_id" << 1 << "n" << GTE << 3 ) ).sort( "n" ),
+                                                           -5, 0, 0, QueryOption_DirectSend );
+            for(int i=3; i<8; i++)
+                ASSERT_EQUALS( i, c->next()["n"].numberInt() );
+            ASSERT( !c->more() );
+        }
+    };
+
+    class AdaptiveBatchSize {
+    public:
+        void run() {
+            ReplyBatchSizer s;
+            // nothing to go on yet
+            ASSERT_EQUALS( MaxBytesToReturnToClientAtOnce , s.nextBatchBytes() );
+            ASSERT_EQUALS( MaxBytesToReturnToClientAtOnce , s.bufferHint( 10 ) );
+
+            s.sent( 100 , 10000 );
+            ASSERT_EQUALS( 100 , s.avgObjSize() );
+            ASSERT_EQUALS( 10 * 100 + 100 , s.bufferHint( 10 ) );
+            ASSERT_EQUALS( MaxBytesToReturnToClientAtOnce + 100 , s.bufferHint( 0 ) );
+
+            // a slow client gets smaller replies...
+            sleepmillis( ReplyBatchSizer::SlowClientMicros / 1000 + 100 );
+            ASSERT_EQUALS( MaxBytesToReturnToClientAtOnce / 2 , s.nextBatchBytes() );
+            // ...and bigger ones again once it keeps up
+            s.sent( 100 , 10000 );
+            ASSERT_EQUALS( MaxBytesToReturnToClientAtOnce , s.nextBatchBytes() );
+        }
+    };
+
+    class CredentialCacheInvalidation : public ClientBase {
+    public:
+        ~CredentialCacheInvalidation() {
+            client().dropCollection( "unittests.system.users" );
+            client().dropCollection( "unittests.querytests.CredentialCacheInvalidation" );
+        }
+        void run() {
+            const char *ns = "unittests.system.users";
+            insert( ns, BSON( "user" << "a" << "pwd" << "x" ) );
+
+            CredentialCache::Credentials c;
+            c.pwd = "x";
+            c.readOnly = false;
+            credentialCache.set( "unittests", "a", c );
+            ASSERT( credentialCache.get( "unittests", "a", c ) );
+
+            // other collections leave it alone
+            insert( "unittests.querytests.CredentialCacheInvalidation", BSON( "a" << 1 ) );
+            ASSERT( credentialCache.get( "unittests", "a", c ) );
+
+            // an in place $set of the password drops it
+            client().update( ns, QUERY( "user" << "a" ), BSON( "$set" << BSON( "pwd" << "y" ) ) );
+            ASSERT( !credentialCache.get( "unittests", "a", c ) );
+
+            credentialCache.set( "unittests", "a", c );
+            client().remove( ns, QUERY( "user" << "a" ) );
+            ASSERT( !credentialCache.get( "unittests", "a", c ) );
+        }
+    };
+
     class ReturnOneOfManyAndTail : public ClientBase {
     public:
         ~ReturnOneOfManyAndTail() {
@@ -311,6 +427,66 @@ namespace QueryTests {
         }
     };
 
+    class InsertBatchIndexed : public ClientBase {
+    public:
+        ~InsertBatchIndexed() {
+            client().dropCollection( "unittests.querytests.InsertBatchIndexed" );
+        }
+        void run() {
+            const char *ns = "unittests.querytests.InsertBatchIndexed";
+            client().ensureIndex( ns, BSON( "a" << 1 ) );
+            client().ensureIndex( ns, BSON( "b" << 1 ) );
+            client().ensureIndex( ns, BSON( "u" << 1 ), true );
+            vector< BSONObj > v;
+            for( int i = 0; i < 500; ++i )
+                v.push_back( BSON( "_id" << i << "a" << ( 499 - i ) << "b" << BSON_ARRAY( i % 7 << 10 ) << "u" << i ) );
+            client().insert( ns, v );
+            ASSERT( !error() );
+            ASSERT_EQUALS( 500U, client().count( ns ) );
+            ASSERT_EQUALS( 499, client().findOne( ns, Query( BSON( "a" << 0 ) ).hint( BSON( "a" << 1 ) ) )[ "_id" ].numberInt() );
+            ASSERT_EQUALS( 71, client().query( ns, Query( BSON( "b" << 3 ) ).hint( BSON( "b" << 1 ) ) )->itcount() );
+            ASSERT_EQUALS( 500, client().query( ns, Query( BSON( "b" << 10 ) ).hint( BSON( "b" << 1 ) ) )->itcount() );
+
+            // a duplicate on the unique index stops the batch; keys of the documents before it are in place
+            v.clear();
+            v.push_back( BSON( "_id" << 1000 << "a" << 1000 << "u" << 1000 ) );
+            v.push_back( BSON( "_id" << 1001 << "a" << 1001 << "u" << 3 ) );
+            v.push_back( BSON( "_id" << 1002 << "a" << 1002 << "u" << 1002 ) );
+            client().insert( ns, v );
+            ASSERT( error() );
+            ASSERT_EQUALS( 501U, client().count( ns ) );
+            ASSERT_EQUALS( 1, client().query( ns, Query( BSON( "a" << GTE << 1000 ) ).hint( BSON( "a" << 1 ) ) )->itcount() );
+        }
+    };
+
+    /** the query and fields of a QueryMessage point into the message buffer, and keep it alive */
+    class QueryMessageSharesBuffer {
+    public:
+        void run() {
+            BSONObj fields = BSON( "b" << 1 );
+            BufBuilder b;
+            b.appendNum( 0 ); // options
+            b.appendStr( "unittests.querytests.QueryMessageSharesBuffer" );
+            b.appendNum( 0 ); // skip
+            b.appendNum( 0 ); // limit
+            BSON( "a" << 1 ).appendSelfToBufBuilder( b );
+            fields.appendSelfToBufBuilder( b );
+            Message m;
+            m.setData( dbQuery, b.buf(), b.len() );
+            DbMessage d( m );
+            QueryMessage q( d );
+            ASSERT( q.query.isOwned() );
+            BSONObj query = q.query;
+            const char *data = query.objdata();
+            ASSERT( data > (const char *) m.singleData() && data < (const char *) m.singleData() + m.size() );
+            m.reset();
+            // no copy, and still readable after the message is gone
+            ASSERT( query.getOwned().objdata() == data );
+            ASSERT_EQUALS( BSON( "a" << 1 ), query );
+            ASSERT_EQUALS( fields, q.fields );
+        }
+    };
+
     class TailableInsertDelete : public ClientBase {
     public:
         ~TailableInsertDelete() {
@@ -1127,6 +1303,24 @@ namespace QueryTests {
             }
         };
 
+        class Exclude {
+        public:
+            void run(){
+                
+                Projection m;
+                m.init( BSON( "b" << 0 << "_id" << 0 ) );
+                ASSERT_EQUALS( BSON( "a" << 1 << "c" << 3 << "d" << 4 ) ,
+                               m.transform( BSON( "_id" << 7 << "a" << 1 << "b" << 2 << "c" << 3 << "d" << 4 ) ) );
+
+                Projection n;
+                n.init( BSON( "x.b" << 0 ) );
+                ASSERT_EQUALS( BSON( "_id" << 7 << "x" << BSON( "a" << 1 << "c" << 3 ) << "y" << 2 ) ,
+                               n.transform( BSON( "_id" << 7 << "x" << BSON( "a" << 1 << "b" << 2 << "c" << 3 ) << "y" << 2 ) ) );
+                ASSERT_EQUALS( BSON( "x" << BSON_ARRAY( BSON( "a" << 1 ) << 5 ) ) ,
+                               n.transform( BSON( "x" << BSON_ARRAY( BSON( "a" << 1 << "b" << 2 ) << 5 ) ) ) );
+            }
+        };
+
         class K1 {
         public:
             void run(){
@@ -1214,14 +1408,21 @@ namespace QueryTests {
             add< CountFields >();
             add< CountQueryFields >();
             add< CountIndexedRegex >();
+            add< CountIndexedRange >();
             add< FindOne >();
             add< BoundedKey >();
             add< GetMore >();
             add< PositiveLimit >();
+            add< ExhaustFallback >();
+            add< DirectSendFallback >();
+            add< AdaptiveBatchSize >();
+            add< CredentialCacheInvalidation >();
             add< ReturnOneOfManyAndTail >();
             add< TailNotAtEnd >();
             add< EmptyTail >();
             add< TailableDelete >();
+            add< InsertBatchIndexed >();
+            add< QueryMessageSharesBuffer >();
             add< TailableInsertDelete >();
             add< TailCappedOnly >();
             add< TailableQueryOnId >();
@@ -1261,6 +1462,7 @@ namespace QueryTests {
             add< OrderingTest >();
 
             add< proj::T1 >();
+            add< proj::Exclude >();
             add< proj::K1 >();
             add< proj::K2 >();
             add< proj::K3 >();
@@ -19,6 +19,7 @@
 
 #include "pch.h"
 #include "../util/sock.h"
+#include "../util/message.h"
 #include "dbtests.h"
 
 namespace SockTests {
@@ -36,11 +37,116 @@ namespace SockTests {
         }
     };
     
+#if !defined(_WIN32)
+    class PortBase {
+    protected:
+        void build( Message& m, int len, char c ) {
+            string s( len, c );
+            m.setData( dbMsg, s.data(), s.size() );
+        }
+        void check( MessagingPort& p, int len, char c ) {
+            Message m;
+            ASSERT( p.recv( m ) );
+            ASSERT_EQUALS( dbMsg, m.operation() );
+            ASSERT_EQUALS( len, m.dataSize() );
+            ASSERT( string( m.singleData()->_data, len ) == string( len, c ) );
+        }
+    };
+
+    /** messages sent back to back come out whole and in order, however big and however they were sent */
+    class PipelinedMessages : public PortBase {
+    public:
+        void run() {
+            int s[2];
+            ASSERT_EQUALS( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, s ) );
+            SockAddr none;
+            MessagingPort a( s[0], none );
+            MessagingPort b( s[1], none );
+
+            Message m1;
+            build( m1, 100, 'a' );
+            a.piggyBack( m1 );
+            Message m2;
+            build( m2, 50, 'b' );
+            a.say( m2 ); // sent along with m1
+
+            Message m3;
+            build( m3, 20000, 'c' ); // more than is read ahead
+            a.say( m3 );
+
+            // in two buffers
+            Message m4;
+            MsgData *h = (MsgData *) malloc( MsgDataHeaderSize + 10 );
+            h->setOperation( dbMsg );
+            memset( h->_data, 'd', 10 );
+            m4.appendData( (char *) h, MsgDataHeaderSize + 10 );
+            char *rest = (char *) malloc( 30 );
+            memset( rest, 'd', 30 );
+            m4.appendData( rest, 30 );
+            a.say( m4 );
+
+            for ( int i = 0; i < 20; i++ ) {
+                Message m;
+                build( m, i, 'e' );
+                a.say( m );
+            }
+
+            check( b, 100, 'a' );
+            check( b, 50, 'b' );
+            check( b, 20000, 'c' );
+            check( b, 40, 'd' );
+            for ( int i = 0; i < 20; i++ )
+                check( b, i, 'e' );
+        }
+    };
+
+    /** replies to requests that were already waiting are held back, but none are lost or reordered */
+    class PipelinedReplies : public PortBase {
+    public:
+        void run() {
+            int s[2];
+            ASSERT_EQUALS( 0, socketpair( AF_UNIX, SOCK_STREAM, 0, s ) );
+            SockAddr none;
+            MessagingPort client( s[0], none );
+            MessagingPort server( s[1], none );
+
+            unsigned ids[5];
+            for ( int i = 0; i < 5; i++ ) {
+                Message m;
+                build( m, 10, 'q' );
+                client.say( m );
+                ids[i] = m.header()->id;
+            }
+
+            for ( int i = 0; i < 5; i++ ) {
+                Message request;
+                ASSERT( server.recv( request ) );
+                ASSERT_EQUALS( ids[i], request.header()->id.get() );
+                Message response;
+                build( response, i == 2 ? 5000 : 20, 'r' + i );
+                server.reply( request, response );
+            }
+
+            for ( int i = 0; i < 5; i++ ) {
+                Message response;
+                ASSERT( client.recv( response ) );
+                ASSERT_EQUALS( ids[i], response.header()->responseTo.get() );
+                ASSERT_EQUALS( i == 2 ? 5000 : 20, response.dataSize() );
+                ASSERT_EQUALS( (char)( 'r' + i ), response.singleData()->_data[0] );
+            }
+        }
+    };
+#endif
+
     class All : public Suite {
     public:
         All() : Suite( "sock" ){}
         void setupTests(){
             add< HostByName >();
+#if !defined(_WIN32)
+            add< PipelinedMessages >();
+            add< PipelinedReplies >();
+#endif
         }
     } myall;
     
@@ -21,6 +21,8 @@
 #include "../bson/util/atomic_int.h"
 #include "../util/concurrency/mvar.h"
 #include "../util/concurrency/thread_pool.h"
+#include "../util/timer.h"
+#include "../db/admission.h"
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
 
@@ -80,6 +82,34 @@ namespace ThreadedTests {
             ASSERT_EQUALS(2u, u--);
             ASSERT_EQUALS(0u, --u);
             ASSERT_EQUALS(0u, u);
+            ASSERT_EQUALS(5u, u.signedAdd(5));
+            ASSERT_EQUALS(2u, u.signedAdd(-3));
+        }
+    };
+
+    /** ids made concurrently are all distinct; also reports how long they took */
+    class OIDGeneration : public ThreadedTest<> {
+        static const int iterations = 200000;
+        mongo::mutex _m;
+        set<OID> _all;
+        Timer _t;
+
+        public:
+        OIDGeneration() : _m( "OIDGeneration" ) {}
+        void setup() {
+            _t.reset();
+        }
+        void subthread(){
+            vector<OID> mine( iterations );
+            for(int i=0; i < iterations; i++){
+                mine[i].init();
+            }
+            scoped_lock lk( _m );
+            _all.insert( mine.begin(), mine.end() );
+        }
+        void validate(){
+            log() << "OIDGeneration: " << nthreads * iterations << " ids in " << _t.millis() << "ms" << endl;
+            ASSERT_EQUALS( (size_t) nthreads * iterations , _all.size() );
         }
     };
 
@@ -143,6 +173,80 @@ namespace ThreadedTests {
         }
     };
 
+    class AdmissionLimitTest : public ThreadedTest<> {
+        AdmissionControl _ac;
+        mongo::mutex _m;
+        int _running;
+        int _max;
+    public:
+        AdmissionLimitTest() : _m("AdmissionLimitTest") , _running(0) , _max(0) {}
+        void setup(){
+            _ac.setLimit( AdmissionControl::Write , 2 );
+        }
+        void subthread(){
+            AdmissionControl::Ticket t( _ac , AdmissionControl::Write , AdmissionControl::Normal );
+            {
+                scoped_lock lk( _m );
+                _running++;
+                _max = max( _max , _running );
+            }
+            sleepmillis( 5 );
+            scoped_lock lk( _m );
+            _running--;
+        }
+        void validate(){
+            ASSERT( _max <= 2 );
+            ASSERT_EQUALS( 0 , _ac.queued( AdmissionControl::Write ) );
+            BSONObjBuilder b;
+            _ac.append( b );
+            BSONObj o = b.obj();
+            ASSERT_EQUALS( nthreads , o["writes"]["admitted"].numberInt() );
+            ASSERT_EQUALS( 0 , o["writes"]["running"].numberInt() );
+            ASSERT_EQUALS( 0 , o["reads"]["admitted"].numberInt() );
+        }
+    };
+
+    class AdmissionPriorityTest {
+        AdmissionControl _ac;
+        mongo::mutex _m;
+        vector<int> _order;
+
+        void waiter( int p ){
+            AdmissionControl::Ticket t( _ac , AdmissionControl::Read , (AdmissionControl::Priority)p );
+            scoped_lock lk( _m );
+            _order.push_back( p );
+        }
+        void waitQueued( int n ){
+            for ( int i=0; i<1000 && _ac.queued( AdmissionControl::Read ) < n; i++ )
+                sleepmillis( 1 );
+            ASSERT_EQUALS( n , _ac.queued( AdmissionControl::Read ) );
+        }
+    public:
+        AdmissionPriorityTest() : _m("AdmissionPriorityTest") {}
+        void run(){
+            _ac.setLimit( AdmissionControl::Read , 1 );
+            scoped_ptr<AdmissionControl::Ticket> first( new AdmissionControl::Ticket( _ac , AdmissionControl::Read , AdmissionControl::Normal ) );
+
+            boost::thread low( boost::bind( &AdmissionPriorityTest::waiter , this , (int)AdmissionControl::Low ) );
+            waitQueued( 1 );
+            boost::thread high( boost::bind( &AdmissionPriorityTest::waiter , this , (int)AdmissionControl::High ) );
+            waitQueued( 2 );
+
+            first.reset();
+            low.join();
+            high.join();
+
+            ASSERT_EQUALS( 2U , _order.size() );
+            ASSERT_EQUALS( (int)AdmissionControl::High , _order[0] );
+            ASSERT_EQUALS( (int)AdmissionControl::Low , _order[1] );
+
+            // no limit: nothing is counted or queued
+            _ac.setLimit( AdmissionControl::Read , 0 );
+            AdmissionControl::Ticket t( _ac , AdmissionControl::Read , AdmissionControl::Low );
+            ASSERT_EQUALS( 0 , _ac.queued( AdmissionControl::Read ) );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "threading" ){
@@ -150,9 +254,12 @@ namespace ThreadedTests {
 
         void setupTests(){
             add< IsAtomicUIntAtomic >();
+            add< OIDGeneration >();
             add< MVarTest >();
             add< ThreadPoolTest >();
             add< LockTest >();
+            add< AdmissionLimitTest >();
+            add< AdmissionPriorityTest >();
         }
     } myall;
 }
@@ -183,6 +183,51 @@ namespace UpdateTests {
         }
     };
 
+    class SetShrinkThenGrowInPlace : public SetBase {
+    public:
+        void run() {
+            client().insert( ns(), fromjson( "{'_id':0,a:'abcdefgh',b:[1]}" ) );
+            client().update( ns(), Query(), BSON( "$set" << BSON( "a" << "x" ) ) );
+            ASSERT_EQUALS( client().findOne( ns(), Query() ), fromjson( "{'_id':0,a:'x',b:[1]}" ) );
+            // the record keeps the space freed above, so this grows within it
+            client().update( ns(), Query(), BSON( "$push" << BSON( "b" << 2 ) ) );
+            ASSERT_EQUALS( client().findOne( ns(), Query() ), fromjson( "{'_id':0,a:'x',b:[1,2]}" ) );
+            client().update( ns(), Query(), BSON( "$set" << BSON( "a" << "y" ) ) );
+            ASSERT_EQUALS( client().findOne( ns(), Query() ), fromjson( "{'_id':0,a:'y',b:[1,2]}" ) );
+        }
+    };
+
+    class MoveKeepsIndexes : public SetBase {
+    public:
+        void run() {
+            client().ensureIndex( ns(), BSON( "a" << 1 ) );
+            client().ensureIndex( ns(), BSON( "b" << 1 ) );
+            for( int i = 0; i < 100; ++i )
+                client().insert( ns(), BSON( "_id" << i << "a" << i << "b" << ( i % 3 ) ) );
+            string big( 1000, 'x' );
+            for( int i = 0; i < 100; i += 7 ) {
+                client().update( ns(), BSON( "_id" << i ), BSON( "$set" << BSON( "c" << big ) ) );
+                client().update( ns(), BSON( "_id" << i + 1 ), BSON( "$set" << BSON( "c" << big << "a" << -1000 - i ) ) );
+            }
+            ASSERT_EQUALS( 100U, client().count( ns(), BSONObj() ) );
+            ASSERT_EQUALS( 30U, client().count( ns(), BSON( "c" << big ) ) );
+            for( int i = 0; i < 100; i += 7 ) {
+                ASSERT_EQUALS( i, client().findOne( ns(), Query( BSON( "a" << i ) ).hint( BSON( "a" << 1 ) ) )[ "_id" ].numberInt() );
+                ASSERT_EQUALS( i + 1, client().findOne( ns(), Query( BSON( "a" << -1000 - i ) ).hint( BSON( "a" << 1 ) ) )[ "_id" ].numberInt() );
+                ASSERT( client().findOne( ns(), Query( BSON( "a" << i + 1 ) ).hint( BSON( "a" << 1 ) ) ).isEmpty() );
+            }
+            for( int j = 0; j < 3; ++j ) {
+                auto_ptr< DBClientCursor > c = client().query( ns(), Query( BSON( "b" << j ) ).hint( BSON( "b" << 1 ) ) );
+                int n = 0;
+                while( c->more() ) {
+                    ASSERT_EQUALS( j, c->next()[ "_id" ].numberInt() % 3 );
+                    ++n;
+                }
+                ASSERT_EQUALS( j == 0 ? 34 : 33, n );
+            }
+        }
+    };
+
     class ModDotted : public SetBase {
     public:
         void run() {
@@ -819,6 +864,8 @@ namespace UpdateTests {
             add< SetStringDifferentLength >();
             add< SetStringToNum >();
             add< SetStringToNumInPlace >();
+            add< SetShrinkThenGrowInPlace >();
+            add< MoveKeepsIndexes >();
             add< ModDotted >();
             add< SetInPlaceDotted >();
             add< SetRecreateDotted >();
@@ -0,0 +1,31 @@
+// request admission limits and priorities
+
+t = db.admission1;
+t.drop();
+
+var res = db.adminCommand( { admissionControl : 1 , reads : 2 , writes : 1 , commands : 4 } );
+assert( res.ok , "set limits" );
+assert.eq( 2 , res.reads.limit , "reads" );
+assert.eq( 1 , res.writes.limit , "writes" );
+
+res = db.adminCommand( { admissionControl : 1 , db : db.getName() , priority : "low" } );
+assert.eq( "low" , res.dbPriorities[ db.getName() ] , "db priority" );
+assert( ! db.adminCommand( { admissionControl : 1 , db : db.getName() , priority : "urgent" } ).ok , "bad priority" );
+
+for ( var i = 0; i < 100; i++ )
+    t.insert( { _id : i } );
+db.getLastError();
+assert.eq( 100 , t.find().itcount() , "find" );
+
+res = db.serverStatus().admission;
+assert( res.writes.admitted >= 100 , "writes admitted" );
+assert.eq( 0 , res.writes.running , "writes running" );
+assert.eq( 0 , res.reads.queued , "reads queued" );
+
+assert.eq( "default" , db.runCommand( { setPriority : "normal" } ).was , "setPriority" );
+assert( ! db.runCommand( { setPriority : "bogus" } ).ok , "bad setPriority" );
+db.runCommand( { setPriority : "default" } );
+
+// back to unlimited
+db.adminCommand( { admissionControl : 1 , reads : 0 , writes : 0 , commands : 0 , db : db.getName() , priority : "normal" } );
+assert.eq( 0 , db.serverStatus().admission.writes.limit , "reset" );
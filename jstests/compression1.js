@@ -0,0 +1,24 @@
+// wire compression, agreed on through isMaster
+
+t = db.compression1;
+t.drop();
+
+var big = "";
+while ( big.length < 200 )
+    big += "compression ";
+for ( var i = 0; i < 1000; i++ )
+    t.insert( { _id : i , s : big } );
+db.getLastError();
+
+// nothing we can do
+var res = db.adminCommand( { isMaster : 1 , compression : [ "nonesuch" ] } );
+assert( res.ok , "isMaster" );
+assert( ! res.compression , "unknown compressor" );
+
+res = db.adminCommand( { isMaster : 1 , compression : [ "nonesuch" , "lz" ] } );
+assert.eq( "lz" , res.compression , "agreed" );
+
+// replies to this shell are compressed from here on
+assert.eq( 1000 , t.find().itcount() , "find" );
+assert.eq( big , t.findOne( { _id : 999 } ).s , "findOne" );
+assert.eq( 1000 , t.count() , "count" );
@@ -0,0 +1,27 @@
+// a mongod accepting connections on several threads (--acceptThreads), and on a linux abstract unix socket
+
+port = allocatePorts( 1 )[ 0 ];
+var baseName = "jstests_disk_acceptthreads1";
+
+var linux = ! _isWindows() && /linux/i.test( db.adminCommand( "buildinfo" ).sysInfo );
+var bind = "127.0.0.1";
+if ( linux )
+    bind += ",@" + baseName + "-" + port;
+
+var m = startMongod( "--port", port, "--dbpath", "/data/db/" + baseName, "--nohttpinterface", "--bind_ip", bind, "--acceptThreads", 4 );
+m.getDB( "test" ).foo.save( { a : 1 } );
+
+// new connections get served whichever thread takes them
+var conns = [];
+for ( var i = 0; i < 50; i++ ) {
+    conns.push( new Mongo( "127.0.0.1:" + port ) );
+    assert.eq( 1, conns[ i ].getDB( "test" ).foo.count(), "connection " + i );
+}
+
+if ( linux ) {
+    var sock = new Mongo( "@" + baseName + "-" + port );
+    assert( sock.getDB( "test" ).runCommand( "ping" ).ok, "ping over abstract socket" );
+    assert.eq( 1, sock.getDB( "test" ).foo.count(), "count over abstract socket" );
+}
+
+stopMongod( port );
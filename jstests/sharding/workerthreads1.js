@@ -0,0 +1,32 @@
+// a mongos serving all its connections from an epoll loop and a fixed set of workers (--workerThreads)
+
+s = new ShardingTest( "workerthreads1" , 2 , 0 );
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { _id : 1 } } );
+
+var port = 31100;
+var conn = startMongos( { port : port , configdb : s._configDB , workerThreads : 2 } );
+
+// more connections than workers, used in turn
+var conns = [];
+for ( var i = 0; i < 20; i++ )
+    conns.push( new Mongo( "127.0.0.1:" + port ) );
+
+for ( var i = 0; i < 500; i++ ){
+    var db = conns[ i % conns.length ].getDB( "test" );
+    db.foo.insert( { _id : i , x : "workerthreads" } );
+    assert.eq( null , db.getLastError() , "insert " + i );
+}
+
+for ( var i = 0; i < conns.length; i++ ){
+    var db = conns[i].getDB( "test" );
+    assert.eq( 500 , db.foo.find().itcount() , "find on connection " + i ); // with getMores
+    assert.eq( 500 , db.foo.count() , "count on connection " + i );
+}
+
+// a connection going away doesn't disturb the others
+conns.pop();
+assert.eq( 1 , conns[0].getDB( "test" ).foo.find( { _id : 7 } ).itcount() , "after close" );
+
+stopMongoProgram( port );
+s.stop();
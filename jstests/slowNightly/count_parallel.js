@@ -0,0 +1,27 @@
+// counts over an unindexed scan should be the same whether or not they are run in parallel
+
+t = db.jstests_count_parallel;
+t.drop();
+
+for( i = 0; i < 120000; ++i ) {
+    t.save( { i: i, m: i % 7 } );
+}
+db.getLastError();
+
+admin = db.getSisterDB( "admin" );
+old = admin.runCommand( { getParameter: 1, parallelScan: 1 } ).parallelScan;
+
+function check( tag ) {
+    assert.eq( 17143, t.count( { m: 0 } ), tag + " A" );
+    assert.eq( 60000, t.count( { i: { $lt: 60000 } } ), tag + " B" );
+    assert.eq( 10, t.find( { m: 3 } ).limit( 10 ).count( true ), tag + " C" );
+    assert.eq( 0, t.count( { m: 8 } ), tag + " D" );
+}
+
+assert.commandWorked( admin.runCommand( { setParameter: 1, parallelScan: 0 } ) );
+check( "serial" );
+assert.commandWorked( admin.runCommand( { setParameter: 1, parallelScan: 4 } ) );
+check( "parallel" );
+admin.runCommand( { setParameter: 1, parallelScan: old } );
+
+t.drop();
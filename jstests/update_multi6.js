@@ -0,0 +1,27 @@
+
+// multi updates of indexed fields apply their index changes in batches
+
+t = db.update_multi6;
+t.drop();
+
+t.ensureIndex( { a : 1 } );
+t.ensureIndex( { b : 1 } );
+t.ensureIndex( { u : 1 } , true );
+
+N = 1000;
+for ( i = 0; i < N; i++ )
+    t.save( { _id : i , a : i , b : i % 10 , u : i } );
+
+t.update( { b : { $lt : 5 } } , { $inc : { a : N , u : N } } , false , true );
+assert( !db.getLastError() , "update" );
+
+assert.eq( N / 2 , t.find( { a : { $gte : N } } ).hint( { a : 1 } ).itcount() , "a moved" );
+assert.eq( N / 2 , t.find( { a : { $lt : N } } ).hint( { a : 1 } ).itcount() , "a stayed" );
+assert.eq( N / 2 , t.find( { u : { $gte : N } } ).hint( { u : 1 } ).itcount() , "u moved" );
+t.find( { a : { $gte : N } } ).forEach( function( z ) { assert.eq( z._id + N , z.a , "a value" ); } );
+
+// each document is only updated once, even though its new key lies ahead of the cursor
+t.update( { a : { $gte : 0 } } , { $inc : { a : 1 } } , false , true );
+assert.eq( N , t.find( { $where : "this.a == this._id + 1 || this.a == this._id + " + ( N + 1 ) } ).itcount() , "once" );
+
+assert( t.validate().valid , "validate" );
@@ -769,6 +769,7 @@ namespace mongo {
                 result.append("ismaster", 1.0 );
                 result.append("msg", "isdbgrid");
                 result.appendNumber("maxBsonObjectSize", BSONObjMaxUserSize);
+                negotiateCompression( cmdObj , result , ClientInfo::get()->port() );
                 return true;
             }
         } ismaster;
@@ -161,7 +161,7 @@ namespace mongo {
         _p->reply( _m , response , _id );
     }
     
-    ClientInfo::ClientInfo( int clientId ) : _id( clientId ){
+    ClientInfo::ClientInfo( int clientId ) : _id( clientId ) , _port( 0 ){
         _cur = &_a;
         _prev = &_b;
         newRequest();
@@ -193,6 +193,7 @@ namespace mongo {
                 ss << "remotes don't match old [" << _remote << "] new [" << r << "]";
                 throw UserException( 13134 , ss.str() );
             }
+            _port = p;
         }
         
         _lastAccess = (int) time(0);
@@ -120,6 +120,9 @@ namespace mongo {
         
         string getRemote() const { return _remote; }
 
+        /** the client's connection, as of its last request; 0 if we haven't had one */
+        AbstractMessagingPort * port() const { return _port; }
+
         void addShard( const string& shard );
         set<string> * getPrev() const { return _prev; };
         
@@ -137,6 +140,7 @@ namespace mongo {
     private:
         int _id;
         string _remote;
+        AbstractMessagingPort * _port;
 
         set<string> _a;
         set<string> _b;
@@ -189,6 +189,7 @@ int main(int argc, char* argv[]) {
         ( "chunkSize" , po::value<int>(), "maximum amount of data per chunk" )
         ( "ipv6", "enable IPv6 support (disabled by default)" )
         ( "jsonp","allow JSONP access via http (has security implications)" )
+        ( "workerThreads" , po::value<int>() , "(linux) serve all connections from an epoll loop and this many threads, instead of a thread per connection" )
         ;
 
     options.add(sharding_options);
@@ -306,6 +307,13 @@ int main(int argc, char* argv[]) {
     MessageServer::Options opts;
     opts.port = cmdLine.port;
     opts.ipList = cmdLine.bind_ip;
+    if ( params.count( "workerThreads" ) ){
+        opts.workerThreads = params["workerThreads"].as<int>();
+        if ( opts.workerThreads <= 0 ){
+            out() << "workerThreads has to be greater than 0" << endl;
+            return 9;
+        }
+    }
     start(opts);
 
     dbexit( EXIT_CLEAN );
@@ -33,6 +33,7 @@ namespace po = boost::program_options;
 class BSONDump : public BSONTool {
 
     enum OutputType { JSON , DEBUG } _type;
+    StringBuilder _json; // reused for each object
 
 public:
     
@@ -122,7 +123,10 @@ public:
     virtual void gotObject( const BSONObj& o ){
         switch ( _type ){
         case JSON:
-            cout << o.jsonString( TenGen ) << endl;
+            _json.reset();
+            o.jsonString( _json , TenGen );
+            cout.write( _json.data() , _json.len() );
+            cout << endl;
             break;
         case DEBUG:
             debug(o);
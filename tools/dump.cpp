@@ -67,17 +67,14 @@ public:
         DBClientBase& connBase = conn(true);
         Writer writer(out, m);
 
-        // use low-latency "exhaust" mode if going over the network
-        if (typeid(connBase) == typeid(DBClientConnection&)){
-            DBClientConnection& conn = static_cast<DBClientConnection&>(connBase);
-            boost::function<void(const BSONObj&)> castedWriter(writer); // needed for overload resolution
-            conn.query( castedWriter, coll.c_str() , q , NULL, queryOptions | QueryOption_Exhaust);
-        } else {
-            //This branch should only be taken with DBDirectClient which doesn't support exhaust mode
-            scoped_ptr<DBClientCursor> cursor(connBase.query( coll.c_str() , q , 0 , 0 , 0 , queryOptions ));
-            while ( cursor->more() ) {
-                writer(cursor->next());
-            }
+        // use low-latency "exhaust" mode if the server has it.  the cursor drops it 
+        // by itself where it can't stream (DBDirectClient)
+        if ( connBase.availableOptions() & QueryOption_Exhaust )
+            queryOptions |= QueryOption_Exhaust;
+
+        scoped_ptr<DBClientCursor> cursor(connBase.query( coll.c_str() , q , 0 , 0 , 0 , queryOptions ));
+        while ( cursor->more() ) {
+            writer(cursor->next());
         }
     }
 
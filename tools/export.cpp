@@ -94,7 +94,11 @@ public:
         if ( q.getFilter().isEmpty() && !hasParam("dbpath"))
             q.snapshot();
 
-        auto_ptr<DBClientCursor> cursor = conn().query( ns.c_str() , q , 0 , 0 , fieldsToReturn , QueryOption_SlaveOk | QueryOption_NoCursorTimeout );
+        int queryOptions = QueryOption_SlaveOk | QueryOption_NoCursorTimeout;
+        if ( conn().availableOptions() & QueryOption_Exhaust )
+            queryOptions |= QueryOption_Exhaust; // we read it all, so let the server stream it
+
+        auto_ptr<DBClientCursor> cursor = conn().query( ns.c_str() , q , 0 , 0 , fieldsToReturn , queryOptions );
 
         if ( csv ){
             for ( vector<string>::iterator i=_fields.begin(); i != _fields.end(); i++ ){
@@ -108,6 +112,7 @@ public:
         if (jsonArray)
             out << '[';
 
+        StringBuilder json;
         long long num = 0;
         while ( cursor->more() ) {
             num++;
@@ -118,19 +123,23 @@ public:
                         out << ",";
                     const BSONElement & e = obj.getFieldDotted(i->c_str());
                     if ( ! e.eoo() ){
-                        out << e.jsonString( Strict , false );
+                        json.reset();
+                        e.jsonString( json , Strict , false );
+                        out.write( json.data() , json.len() );
                     }
                 }
-                out << endl;
+                out << '\n';
             }
             else {
                 if (jsonArray && num != 1)
                     out << ',';
 
-                out << obj.jsonString();
+                json.reset();
+                obj.jsonString( json );
+                out.write( json.data() , json.len() );
 
                 if (!jsonArray)
-                    out << endl;
+                    out << '\n';
             }
         }
 
@@ -24,7 +24,8 @@ namespace mongo {
         
         Alphabet alphabet;
 
-        void encode( stringstream& ss , const char * data , int size ){
+        template< class Stream >
+        static void _encode( Stream& ss , const char * data , int size ){
             for ( int i=0; i<size; i+=3 ){
                 int left = size - i;
                 const unsigned char * start = (const unsigned char*)data + i;
@@ -63,11 +64,18 @@ namespace mongo {
             }
         }
 
+        void encode( stringstream& ss , const char * data , int size ){
+            _encode( ss , data , size );
+        }
+
+        void encode( StringBuilder& sb , const char * data , int size ){
+            _encode( sb , data , size );
+        }
 
         string encode( const char * data , int size ){
-            stringstream ss;
-            encode( ss , data ,size );
-            return ss.str();
+            StringBuilder sb;
+            encode( sb , data ,size );
+            return sb.str();
         }
         
         string encode( const string& s ){
@@ -0,0 +1,169 @@
+// util/compress.cpp
+
+/*    Copyright 2010 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "pch.h"
+#include "compress.h"
+
+namespace mongo {
+
+    namespace {
+
+        const int MinMatch = 4;
+        const int MaxOffset = 0xffff;
+        const int HashBits = 12;
+
+        inline unsigned read32( const char *p ) {
+            unsigned x;
+            memcpy( &x , p , 4 );
+            return x;
+        }
+
+        inline unsigned hash4( const char *p ) {
+            return ( read32( p ) * 2654435761U ) >> ( 32 - HashBits );
+        }
+
+        /* n is what is left over after the 15 in the token */
+        char * putLength( char *op , int n ) {
+            while ( n >= 255 ) {
+                *op++ = (char) 255;
+                n -= 255;
+            }
+            *op++ = (char) n;
+            return op;
+        }
+
+        /* matchLen 0 for the last sequence, which has no match */
+        char * putSequence( char *op , const char *lit , int litLen , int offset , int matchLen ) {
+            char *token = op++;
+            int t = litLen < 15 ? litLen : 15;
+            if ( litLen >= 15 )
+                op = putLength( op , litLen - 15 );
+            memcpy( op , lit , litLen );
+            op += litLen;
+
+            if ( matchLen == 0 ) {
+                *token = (char) ( t << 4 );
+                return op;
+            }
+
+            *op++ = (char) ( offset & 0xff );
+            *op++ = (char) ( offset >> 8 );
+            int m = matchLen - MinMatch;
+            *token = (char) ( ( t << 4 ) | ( m < 15 ? m : 15 ) );
+            if ( m >= 15 )
+                op = putLength( op , m - 15 );
+            return op;
+        }
+
+        bool getLength( const unsigned char *& ip , const unsigned char *end , int& n ) {
+            while ( 1 ) {
+                if ( ip >= end )
+                    return false;
+                unsigned b = *ip++;
+                n += b;
+                if ( n > 0x40000000 )
+                    return false;
+                if ( b != 255 )
+                    return true;
+            }
+        }
+
+    }
+
+    int compressBlock( const char *in , int len , char *out ) {
+        int table[ 1 << HashBits ];
+        for ( int i = 0; i < ( 1 << HashBits ); i++ )
+            table[i] = -1;
+
+        const char *ip = in;
+        const char *anchor = in;
+        const char *end = in + len;
+        char *op = out;
+
+        while ( end - ip >= MinMatch ) {
+            unsigned h = hash4( ip );
+            int ref = table[h];
+            int pos = ip - in;
+            table[h] = pos;
+
+            if ( ref < 0 || pos - ref > MaxOffset || read32( in + ref ) != read32( ip ) ) {
+                // step faster through data that isn't compressing
+                ip += 1 + ( ( ip - anchor ) >> 6 );
+                continue;
+            }
+
+            const char *m = in + ref + MinMatch;
+            const char *p = ip + MinMatch;
+            while ( p < end && *p == *m ) {
+                p++;
+                m++;
+            }
+
+            op = putSequence( op , anchor , ip - anchor , pos - ref , p - ip );
+            ip = anchor = p;
+        }
+
+        op = putSequence( op , anchor , end - anchor , 0 , 0 );
+        return op - out;
+    }
+
+    bool decompressBlock( const char *in , int inLen , char *out , int outLen ) {
+        const unsigned char *ip = (const unsigned char *) in;
+        const unsigned char *iend = ip + inLen;
+        char *op = out;
+        char *oend = out + outLen;
+
+        while ( ip < iend ) {
+            unsigned token = *ip++;
+
+            int litLen = token >> 4;
+            if ( litLen == 15 && ! getLength( ip , iend , litLen ) )
+                return false;
+            if ( litLen > iend - ip || litLen > oend - op )
+                return false;
+            memcpy( op , ip , litLen );
+            op += litLen;
+            ip += litLen;
+
+            if ( ip == iend )
+                break;
+
+            if ( iend - ip < 2 )
+                return false;
+            int offset = ip[0] | ( ip[1] << 8 );
+            ip += 2;
+            if ( offset == 0 || offset > op - out )
+                return false;
+
+            int matchLen = token & 15;
+            if ( matchLen == 15 && ! getLength( ip , iend , matchLen ) )
+                return false;
+            matchLen += MinMatch;
+            if ( matchLen > oend - op )
+                return false;
+
+            // byte at a time: the match may overlap what it is writing
+            const char *m = op - offset;
+            for ( int i = 0; i < matchLen; i++ )
+                op[i] = m[i];
+            op += matchLen;
+        }
+
+        return op == oend;
+    }
+
+}
@@ -0,0 +1,53 @@
+// util/compress.h
+
+/*    Copyright 2010 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /* a small LZ77 block codec, used to compress messages on the wire (see dbCompressed).
+       it trades ratio for speed: BSON reply batches repeat field names and values a lot, and that
+       is what it picks up.
+
+       a block is a series of sequences, each
+         token       high 4 bits literal count, low 4 bits match length - 4 (15 means more bytes follow)
+         [count]     255 bytes, then a final byte < 255, added to the literal count
+         literals
+         offset      2 bytes little endian, how far back the match starts
+         [length]    as for count, added to the match length
+       the last sequence stops after its literals.
+    */
+
+    enum MessageCompressor {
+        NoCompressor = 0,
+        LZCompressor = 1
+    };
+
+    /** @return the most compressBlock() can write for len bytes of input */
+    inline int maxCompressedLength( int len ) {
+        return len + len / 255 + 16;
+    }
+
+    /** @param out must have room for maxCompressedLength( len ) bytes
+        @return number of bytes written to out
+    */
+    int compressBlock( const char *in , int len , char *out );
+
+    /** @return false if in is not a well formed block which expands to exactly outLen bytes */
+    bool decompressBlock( const char *in , int inLen , char *out , int outLen );
+
+}
@@ -25,9 +25,11 @@
 #include "../util/background.h"
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>
 #include "../db/cmdline.h"
 #include "../client/dbclient.h"
 #include "../util/time_support.h"
+#include "../util/compress.h"
 
 #ifndef _WIN32
 # ifndef __sunos__
@@ -103,72 +105,117 @@ namespace mongo {
 
     /* listener ------------------------------------------------------------------- */
 
+    /* linux abstract namespace sockets (@name) are unix sockets without a file */
+    static bool isSocketFile( const SockAddr& me ){
+        return me.getType() == AF_UNIX && me.getAddr()[0] != '@';
+    }
+
+    /* a socket bound and listening on me, or INVALID_SOCKET if we can't */
+    static SOCKET listenOn( SockAddr& me , bool reusePort ){
+        SOCKET sock = ::socket(me.getType(), SOCK_STREAM, 0);
+        if ( sock == INVALID_SOCKET ) {
+            log() << "ERROR: listen(): invalid socket? " << errnoWithDescription() << endl;
+        }
+
+        if (me.getType() == AF_INET6) {
+            // IPv6 can also accept IPv4 connections as mapped addresses (::ffff:127.0.0.1)
+            // That causes a conflict if we don't do set it to IPV6_ONLY
+            const int one = 1;
+            setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char*) &one, sizeof(one));
+        }
+
+        prebindOptions( sock );
+
+#if defined(SO_REUSEPORT)
+        if ( reusePort ) {
+            const int one = 1;
+            if ( setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, (const char*) &one, sizeof(one)) != 0 )
+                log() << "listen(): can't set SO_REUSEPORT " << errnoWithDescription() << endl;
+        }
+#endif
+        
+        if ( ::bind(sock, me.raw(), me.addressSize) != 0 ) {
+            int x = errno;
+            log() << "listen(): bind() failed " << errnoWithDescription(x) << " for socket: " << me.toString() << endl;
+            if ( x == EADDRINUSE )
+                log() << "  addr already in use" << endl;
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+
+#if !defined(_WIN32)
+        if (isSocketFile(me)){
+            if (chmod(me.getAddr().c_str(), 0777) == -1){
+                log() << "couldn't chmod socket file " << me << errnoWithDescription() << endl;
+            }
+
+            ListeningSockets::get()->addPath( me.getAddr() );
+        }
+#endif
+
+        if ( ::listen(sock, 128) != 0 ) {
+            log() << "listen(): listen() failed " << errnoWithDescription() << endl;
+            closesocket(sock);
+            return INVALID_SOCKET;
+        }
+
+        ListeningSockets::get()->add( sock );
+        return sock;
+    }
+
     void Listener::initAndListen() {
         checkTicketNumbers();
         vector<SockAddr> mine = ipToAddrs(_ip.c_str(), _port);
-        vector<int> socks;
-        SOCKET maxfd = 0; // needed for select()
+
+        int nThreads = _acceptThreads;
+#if !defined(SO_REUSEPORT)
+        if ( nThreads > 1 ) {
+            log() << "no SO_REUSEPORT on this platform, accepting connections on one thread" << endl;
+            nThreads = 1;
+        }
+#endif
+
+        // what each accepting thread listens on.  with more than one, every tcp address gets a socket
+        // per thread, all bound with SO_REUSEPORT, and the kernel spreads new connections over them
+        vector< vector<int> > socks( nThreads );
 
         for (vector<SockAddr>::iterator it=mine.begin(), end=mine.end(); it != end; ++it){
             SockAddr& me = *it;
 
-            SOCKET sock = ::socket(me.getType(), SOCK_STREAM, 0);
-            if ( sock == INVALID_SOCKET ) {
-                log() << "ERROR: listen(): invalid socket? " << errnoWithDescription() << endl;
-            }
-
-            if (me.getType() == AF_UNIX){
 #if !defined(_WIN32)
-                if (unlink(me.getAddr().c_str()) == -1){
-                    int x = errno;
-                    if (x != ENOENT){
-                        log() << "couldn't unlink socket file " << me << errnoWithDescription(x) << " skipping" << endl;
-                        continue;
-                    }
-                }
-#endif
-            } else if (me.getType() == AF_INET6) {
-                // IPv6 can also accept IPv4 connections as mapped addresses (::ffff:127.0.0.1)
-                // That causes a conflict if we don't do set it to IPV6_ONLY
-                const int one = 1;
-                setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char*) &one, sizeof(one));
-            }
-
-            prebindOptions( sock );
-            
-            if ( ::bind(sock, me.raw(), me.addressSize) != 0 ) {
+            if (isSocketFile(me) && unlink(me.getAddr().c_str()) == -1){
                 int x = errno;
-                log() << "listen(): bind() failed " << errnoWithDescription(x) << " for socket: " << me.toString() << endl;
-                if ( x == EADDRINUSE )
-                    log() << "  addr already in use" << endl;
-                closesocket(sock);
-                return;
-            }
-
-#if !defined(_WIN32)
-            if (me.getType() == AF_UNIX){
-                if (chmod(me.getAddr().c_str(), 0777) == -1){
-                    log() << "couldn't chmod socket file " << me << errnoWithDescription() << endl;
+                if (x != ENOENT){
+                    log() << "couldn't unlink socket file " << me << errnoWithDescription(x) << " skipping" << endl;
+                    continue;
                 }
-
-                ListeningSockets::get()->addPath( me.getAddr() );
             }
 #endif
 
-            if ( ::listen(sock, 128) != 0 ) {
-                log() << "listen(): listen() failed " << errnoWithDescription() << endl;
-                closesocket(sock);
-                return;
+            bool shared = nThreads > 1 && me.getType() != AF_UNIX;
+            for ( int t = 0; t < ( shared ? nThreads : 1 ); t++ ) {
+                SOCKET sock = listenOn( me , shared );
+                if ( sock == INVALID_SOCKET )
+                    return;
+                socks[t].push_back(sock);
             }
+        }
+
+        for ( int t = 1; t < nThreads; t++ )
+            boost::thread thr( boost::bind( &Listener::acceptLoop , this , socks[t] , false ) );
+
+        acceptLoop( socks[0] , true );
+    }
 
-            ListeningSockets::get()->add( sock );
+    static AtomicUInt connNumber;
 
-            socks.push_back(sock);
-            if (sock > maxfd)
-                maxfd = sock;
+    void Listener::acceptLoop( vector<int> socks , bool tracksTime ) {
+        SOCKET maxfd = 0; // needed for select()
+        for (vector<int>::iterator it=socks.begin(), end=socks.end(); it != end; ++it){
+            if (*it > maxfd)
+                maxfd = *it;
         }
 
-        static long connNumber = 0;
         struct timeval maxSelectTime;
         while ( ! inShutdown() ) {
             fd_set fds[1];
@@ -183,14 +230,17 @@ namespace mongo {
             const int ret = select(maxfd+1, fds, NULL, NULL, &maxSelectTime);
             
             if (ret == 0){
+                if ( tracksTime ) {
 #if defined(__linux__)
-                _elapsedTime += ( 10000 - maxSelectTime.tv_usec ) / 1000;
+                    _elapsedTime += ( 10000 - maxSelectTime.tv_usec ) / 1000;
 #else
-                _elapsedTime += 10;
+                    _elapsedTime += 10;
 #endif
+                }
                 continue;
             }
-            _elapsedTime += ret; // assume 1ms to grab connection. very rough
+            if ( tracksTime )
+                _elapsedTime += ret; // assume 1ms to grab connection. very rough
             
             if (ret < 0){
                 int x = errno;
@@ -237,6 +287,100 @@ namespace mongo {
         accepted( new MessagingPort(sock, from) );
     }
 
+    /* compression ----------------------------------------------------------------- */
+
+#pragma pack(1)
+    /* the body of a dbCompressed message.  the header's id and responseTo are the original's */
+    struct CompressedMsgHeader {
+        int originalOp;
+        int uncompressedLen; // of the original, less its header
+        char compressor;
+    };
+#pragma pack()
+
+    /* smaller than this isn't worth the cpu */
+    const int CompressMinSize = 512;
+
+    /* @return false if m doesn't get any smaller, in which case send it as it is */
+    static bool compressMessage( Message& m , Message& out , int compressor ) {
+        MsgData *h = m.header();
+        int bodyLen = m.size() - MsgDataHeaderSize;
+
+        // the codec wants the body in one piece
+        char *whole = 0;
+        const char *body = h->_data;
+        if ( ! m.isSingleBuffer() ) {
+            whole = (char *) malloc( m.size() );
+            m.copyTo( whole );
+            body = whole + MsgDataHeaderSize;
+        }
+
+        int most = MsgDataHeaderSize + sizeof( CompressedMsgHeader ) + maxCompressedLength( bodyLen );
+        MsgData *c = (MsgData *) malloc( most );
+        CompressedMsgHeader *ch = (CompressedMsgHeader *) c->_data;
+        int len = MsgDataHeaderSize + sizeof( CompressedMsgHeader ) + compressBlock( body , bodyLen , (char *) ( ch + 1 ) );
+        free( whole );
+
+        if ( len >= m.size() ) {
+            free( c );
+            return false;
+        }
+
+        c->len = len;
+        c->id = h->id;
+        c->responseTo = h->responseTo;
+        c->setOperation( dbCompressed );
+        ch->originalOp = h->operation();
+        ch->uncompressedLen = bodyLen;
+        ch->compressor = (char) compressor;
+        out.setData( c , true );
+        return true;
+    }
+
+    /* replaces m, a dbCompressed message, with the message it holds */
+    static bool decompressMessage( Message& m ) {
+        MsgData *c = m.singleData();
+        int clen = c->dataLen() - sizeof( CompressedMsgHeader );
+        if ( clen < 0 )
+            return false;
+
+        CompressedMsgHeader *ch = (CompressedMsgHeader *) c->_data;
+        if ( ch->compressor != LZCompressor ||
+             ch->uncompressedLen < 0 || ch->uncompressedLen > 48000000 - MsgDataHeaderSize )
+            return false;
+
+        int len = MsgDataHeaderSize + ch->uncompressedLen;
+        MsgData *md = (MsgData *) malloc( len < (int) sizeof( MsgData ) ? sizeof( MsgData ) : len );
+        assert( md );
+        if ( ! decompressBlock( (const char *) ( ch + 1 ) , clen , md->_data , ch->uncompressedLen ) ) {
+            free( md );
+            return false;
+        }
+        md->len = len;
+        md->id = c->id;
+        md->responseTo = c->responseTo;
+        md->setOperation( ch->originalOp );
+
+        m.reset();
+        m.setData( md , true );
+        return true;
+    }
+
+    void negotiateCompression( const BSONObj& isMasterCmd , BSONObjBuilder& result , AbstractMessagingPort * p ) {
+        if ( ! p || isMasterCmd["compression"].type() != Array )
+            return;
+
+        BSONObjIterator i( isMasterCmd["compression"].embeddedObject() );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            if ( e.type() == String && strcmp( e.valuestr() , "lz" ) == 0 ) {
+                result.append( "compression" , "lz" );
+                p->setCompressor( LZCompressor );
+                return;
+            }
+        }
+    }
+
     /* messagingport -------------------------------------------------------------- */
 
     class PiggyBackData {
@@ -250,7 +394,7 @@ namespace mongo {
         ~PiggyBackData() {
             DESTRUCTOR_GUARD (
                 flush();
-                delete[]( _cur );
+                delete[]( _buf );
             );
         }
 
@@ -272,6 +416,15 @@ namespace mongo {
             _cur = _buf;
         }
 
+        /* what's waiting and then m, in one sendmsg rather than copying m in after it */
+        void flushWith( Message& m ) {
+            vector< pair< char *, int > > v;
+            v.push_back( make_pair( _buf , len() ) );
+            m.appendBuffers( v );
+            _cur = _buf;
+            _port->send( v , "say" );
+        }
+
         int len() const { return _cur - _buf; }
 
     private:
@@ -311,12 +464,12 @@ namespace mongo {
         ports.closeAll(mask);
     }
 
-    MessagingPort::MessagingPort(int _sock, const SockAddr& _far) : sock(_sock), piggyBackData(0), _bytesIn(0), _bytesOut(0), farEnd(_far), _timeout(), tag(0) {
+    MessagingPort::MessagingPort(int _sock, const SockAddr& _far) : sock(_sock), piggyBackData(0), _bytesIn(0), _bytesOut(0), _compressor(NoCompressor), _rbuf(0), _rstart(0), _rend(0), _partial(0), _partialLen(0), _partialHave(0), farEnd(_far), _timeout(), tag(0) {
         _logLevel = 0;
         ports.insert(this);
     }
 
-    MessagingPort::MessagingPort( double timeout, int ll ) : _bytesIn(0), _bytesOut(0), tag(0) {
+    MessagingPort::MessagingPort( double timeout, int ll ) : _bytesIn(0), _bytesOut(0), _compressor(NoCompressor), _rbuf(0), _rstart(0), _rend(0), _partial(0), _partialLen(0), _partialHave(0), tag(0) {
         _logLevel = ll;
         ports.insert(this);
         sock = -1;
@@ -334,6 +487,8 @@ namespace mongo {
     MessagingPort::~MessagingPort() {
         if ( piggyBackData )
             delete( piggyBackData );
+        free( _partial );
+        free( _rbuf );
         shutdown();
         ports.erase(this);
     }
@@ -408,15 +563,21 @@ namespace mongo {
         try {
         again:
             mmm( log() << "*  recv() sock:" << this->sock << endl; )
-            int len = -1;
-            
-            char *lenbuf = (char *) &len;
-            int lft = 4;
-            recv( lenbuf, lft );
+            if ( piggyBackData && piggyBackData->len() && ! messageBuffered() ) {
+                // about to wait on the other side, so it mustn't be waiting on us
+                piggyBackData->flush();
+            }
+
+            while ( _rend - _rstart < 4 )
+                fill();
+
+            int len;
+            memcpy( &len , _rbuf + _rstart , 4 );
             
             if ( len < 16 || len > 48000000 ) { // messages must be large enough for headers
                 if ( len == -1 ) {
                     // Endian check from the client, after connecting, to see what mode server is running in.
+                    _rstart += 4;
                     unsigned foo = 0x10203040;
                     send( (char *) &foo, 4, "endian" );
                     goto again;
@@ -440,13 +601,26 @@ namespace mongo {
             assert(z>=len);
             MsgData *md = (MsgData *) malloc(z);
             assert(md);
-            md->len = len;
-            
-            char *p = (char *) &md->id;
-            int left = len -4;
 
             try {
-                recv( p, left );
+                char *p = (char *) md;
+                int have = 0;
+                while ( 1 ) {
+                    int n = _rend - _rstart;
+                    if ( n > len - have )
+                        n = len - have;
+                    memcpy( p + have , _rbuf + _rstart , n );
+                    have += n;
+                    _rstart += n;
+                    if ( have == len )
+                        break;
+                    if ( len - have >= RecvBufSize ) {
+                        // big: the rest goes straight into place
+                        recv( p + have , len - have );
+                        break;
+                    }
+                    fill();
+                }
             } catch (...) {
                 free(md);
                 throw;
@@ -454,6 +628,12 @@ namespace mongo {
             
             _bytesIn += len;
             m.setData(md, true);
+
+            if ( m.operation() == dbCompressed && ! decompressMessage( m ) ) {
+                log(_logLevel) << "MessagingPort recv() bad compressed message from " << farEnd.toString() << endl;
+                m.reset();
+                return false;
+            }
             return true;
             
         } catch ( const SocketException & e ) {
@@ -462,12 +642,112 @@ namespace mongo {
             return false;
         }
     }
+
+    /* true if all of the next message has been read ahead, so recv() won't wait for it */
+    bool MessagingPort::messageBuffered() const {
+        int have = _rend - _rstart;
+        if ( have < 4 )
+            return false;
+        int len;
+        memcpy( &len , _rbuf + _rstart , 4 );
+        return len <= have;
+    }
+
+    void MessagingPort::fill() {
+        if ( ! _rbuf ) {
+            _rbuf = (char *) malloc( RecvBufSize );
+            assert( _rbuf );
+        }
+        if ( _rstart == _rend ) {
+            _rstart = _rend = 0;
+        }
+        else if ( _rstart > 0 ) {
+            memmove( _rbuf , _rbuf + _rstart , _rend - _rstart );
+            _rend -= _rstart;
+            _rstart = 0;
+        }
+        _rend += recvSome( _rbuf + _rend , RecvBufSize - _rend );
+    }
     
+#if !defined(_WIN32)
+    MessagingPort::RecvState MessagingPort::recvNonBlocking(Message& m) {
+        while ( 1 ) {
+            char *into;
+            int want;
+            if ( _partialHave < 4 ) {
+                into = (char *) &_partialLen + _partialHave;
+                want = 4 - _partialHave;
+            }
+            else {
+                into = (char *) _partial + _partialHave;
+                want = _partialLen - _partialHave;
+            }
+
+            int ret = ::recv( sock , into , want , portRecvFlags | MSG_DONTWAIT );
+            if ( ret == 0 ) {
+                log(3) << "MessagingPort recv() conn closed? " << farEnd.toString() << endl;
+                return RecvClosed;
+            }
+            if ( ret < 0 ) {
+                int e = errno;
+                if ( e == EINTR )
+                    continue;
+                if ( e == EAGAIN || e == EWOULDBLOCK )
+                    return RecvMore;
+                log(_logLevel) << "MessagingPort recv() " << errnoWithDescription(e) << " " << farEnd.toString() << endl;
+                return RecvClosed;
+            }
+            _partialHave += ret;
+
+            if ( _partialHave == 4 ) {
+                int len = _partialLen;
+                if ( len == -1 ) {
+                    // Endian check from the client, after connecting, to see what mode server is running in.
+                    unsigned foo = 0x10203040;
+                    try {
+                        send( (char *) &foo, 4, "endian" );
+                    }
+                    catch ( const SocketException& ) {
+                        return RecvClosed;
+                    }
+                    _partialHave = 0;
+                    continue;
+                }
+                if ( len < 16 || len > 48000000 ) { // messages must be large enough for headers
+                    log(0) << "recv(): message len " << len << " is invalid" << endl;
+                    return RecvClosed;
+                }
+                int z = (len+1023)&0xfffffc00;
+                _partial = (MsgData *) malloc(z);
+                assert(_partial);
+                _partial->len = len;
+            }
+            else if ( _partialHave > 4 && _partialHave == _partialLen ) {
+                _bytesIn += _partialLen;
+                m.setData( _partial, true );
+                _partial = 0;
+                _partialHave = 0;
+
+                if ( m.operation() == dbCompressed && ! decompressMessage( m ) ) {
+                    log(_logLevel) << "MessagingPort recv() bad compressed message from " << farEnd.toString() << endl;
+                    m.reset();
+                    return RecvClosed;
+                }
+                return RecvDone;
+            }
+        }
+    }
+#endif
+
     void MessagingPort::reply(Message& received, Message& response) {
-        say(/*received.from, */response, received.header()->id);
+        reply(received, response, received.header()->id);
     }
 
     void MessagingPort::reply(Message& received, Message& response, MSGID responseTo) {
+        if ( messageBuffered() ) {
+            piggyBack( response, responseTo );
+            return;
+        }
         say(/*received.from, */response, responseTo);
     }
 
@@ -502,20 +782,18 @@ namespace mongo {
         toSend.header()->id = nextMessageId();
         toSend.header()->responseTo = responseTo;
 
+        Message compressed;
+        Message *out = &toSend;
+        if ( _compressor && toSend.size() >= CompressMinSize && compressMessage( toSend , compressed , _compressor ) )
+            out = &compressed;
+
         if ( piggyBackData && piggyBackData->len() ) {
             mmm( log() << "*     have piggy back" << endl; )
-            if ( ( piggyBackData->len() + toSend.header()->len ) > 1300 ) {
-                // won't fit in a packet - so just send it off
-                piggyBackData->flush();
-            }
-            else {
-                piggyBackData->append( toSend );
-                piggyBackData->flush();
-                return;
-            }
+            piggyBackData->flushWith( *out );
+            return;
         }
 
-        toSend.send( *this, "say" );
+        out->send( *this, "say" );
     }
 
     // sends all data or throws an exception    
@@ -561,13 +839,14 @@ namespace mongo {
             if ( j->second > 0 ) {
                 d[ i ].iov_base = j->first;
                 d[ i ].iov_len = j->second;
+                _bytesOut += j->second;
                 ++i;
             }
         }
         struct msghdr meta;
         memset( &meta, 0, sizeof( meta ) );
         meta.msg_iov = &d[ 0 ];
-        meta.msg_iovlen = d.size();
+        meta.msg_iovlen = i; // empty buffers were skipped
     
         while( meta.msg_iovlen > 0 ) {
             int ret = ::sendmsg( sock , &meta , portSendFlags );
@@ -599,45 +878,90 @@ namespace mongo {
 #endif
     }
 
+    int MessagingPort::sendNoWait( const vector< pair< char *, int > > &data, const char *context ){
+#if defined(_WIN32)
+        return 0;
+#else
+        if ( piggyBackData )
+            piggyBackData->flush();
+
+        vector< struct iovec > d( data.size() );
+        int i = 0;
+        for( vector< pair< char *, int > >::const_iterator j = data.begin(); j != data.end(); ++j ) {
+            if ( j->second > 0 ) {
+                d[ i ].iov_base = j->first;
+                d[ i ].iov_len = j->second;
+                ++i;
+            }
+        }
+        if ( i == 0 )
+            return 0;
+#if defined(IOV_MAX)
+        // what's past the first IOV_MAX buffers just counts as not sent
+        if ( i > IOV_MAX )
+            i = IOV_MAX;
+#endif
+        struct msghdr meta;
+        memset( &meta, 0, sizeof( meta ) );
+        meta.msg_iov = &d[ 0 ];
+        meta.msg_iovlen = i;
+
+        int ret = ::sendmsg( sock , &meta , portSendFlags | MSG_DONTWAIT );
+        if ( ret == -1 ) {
+            if ( errno == EAGAIN || errno == EWOULDBLOCK )
+                return 0;
+            log(_logLevel) << "MessagingPort " << context << " send() " << errnoWithDescription() << ' ' << farEnd.toString() << endl;
+            throw SocketException( SocketException::SEND_ERROR );
+        }
+        _bytesOut += ret;
+        return ret;
+#endif
+    }
+
     void MessagingPort::recv( char * buf , int len ){
-        unsigned retries = 0;
         while( len > 0 ) {
-            int ret = ::recv( sock , buf , len , portRecvFlags );
+            int ret = recvSome( buf , len );
+            if ( len <= 4 && ret != len )
+                log(_logLevel) << "MessagingPort recv() got " << ret << " bytes wanted len=" << len << endl;
+            assert( ret <= len );
+            len -= ret;
+            buf += ret;
+        }
+    }
+
+    int MessagingPort::recvSome( char * buf , int max ){
+        unsigned retries = 0;
+        while( 1 ) {
+            int ret = ::recv( sock , buf , max , portRecvFlags );
+            if ( ret > 0 )
+                return ret;
             if ( ret == 0 ) {
                 log(3) << "MessagingPort recv() conn closed? " << farEnd.toString() << endl;
                 throw SocketException( SocketException::CLOSED );
             }
-            if ( ret < 0 ) {
-                int e = errno;
+            int e = errno;
 #if defined(EINTR) && !defined(_WIN32)
-                if( e == EINTR ) {
-                    if( ++retries == 1 ) {
-                        log() << "EINTR retry" << endl;
-                        continue;
-                    }
+            if( e == EINTR ) {
+                if( ++retries == 1 ) {
+                    log() << "EINTR retry" << endl;
+                    continue;
                 }
+            }
 #endif
-                if ( e != EAGAIN || _timeout == 0 ) {
-                    SocketException::Type t = SocketException::RECV_ERROR;
+            if ( e != EAGAIN || _timeout == 0 ) {
+                SocketException::Type t = SocketException::RECV_ERROR;
 #if defined(_WINDOWS)
-                    if( e == WSAETIMEDOUT ) t = SocketException::RECV_TIMEOUT;
+                if( e == WSAETIMEDOUT ) t = SocketException::RECV_TIMEOUT;
 #else
-                    /* todo: what is the error code on an SO_RCVTIMEO on linux? EGAIN? EWOULDBLOCK? */
+                /* todo: what is the error code on an SO_RCVTIMEO on linux? EGAIN? EWOULDBLOCK? */
 #endif
-                    log(_logLevel) << "MessagingPort recv() " << errnoWithDescription(e) << " " << farEnd.toString() <<endl;
-                    throw SocketException(t);
-                } else {
-                    if ( !serverAlive( farEnd.toString() ) ) {
-                        log(_logLevel) << "MessagingPort recv() remote dead " << farEnd.toString() << endl;
-                        throw SocketException( SocketException::RECV_ERROR );                        
-                    }
-                }
+                log(_logLevel) << "MessagingPort recv() " << errnoWithDescription(e) << " " << farEnd.toString() <<endl;
+                throw SocketException(t);
             } else {
-                if ( len <= 4 && ret != len )
-                    log(_logLevel) << "MessagingPort recv() got " << ret << " bytes wanted len=" << len << endl;
-                assert( ret <= len );
-                len -= ret;
-                buf += ret;
+                if ( !serverAlive( farEnd.toString() ) ) {
+                    log(_logLevel) << "MessagingPort recv() remote dead " << farEnd.toString() << endl;
+                    throw SocketException( SocketException::RECV_ERROR );                        
+                }
             }
         }
     }
@@ -648,9 +972,9 @@ namespace mongo {
     
     void MessagingPort::piggyBack( Message& toSend , int responseTo ) {
 
-        if ( toSend.header()->len > 1300 ) {
+        if ( toSend.header()->len > 1300 || ! toSend.isSingleBuffer() ) {
             // not worth saving because its almost an entire packet
-            say( toSend );
+            say( toSend , responseTo );
             return;
         }
 
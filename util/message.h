@@ -32,13 +32,19 @@ namespace mongo {
 
     class Listener : boost::noncopyable {
     public:
-        Listener(const string &ip, int p, bool logConnect=true ) : _port(p), _ip(ip), _logConnect(logConnect), _elapsedTime(0){ }
+        Listener(const string &ip, int p, bool logConnect=true ) : _port(p), _ip(ip), _logConnect(logConnect), _elapsedTime(0), _acceptThreads(1){ }
         virtual ~Listener() {
             if ( _timeTracker == this )
                 _timeTracker = 0;
         }
         void initAndListen(); // never returns unless error (start a thread)
 
+        /** accept connections on n threads rather than one.  each tcp address gets a listening socket per
+            thread, bound with SO_REUSEPORT so the kernel spreads new connections over them; unix sockets
+            are accepted on the first thread only.  call before initAndListen().
+        */
+        void setAcceptThreads( int n ) { _acceptThreads = n; }
+
         /* spawn a thread, etc., then return */
         virtual void accepted(int sock, const SockAddr& from);
         virtual void accepted(MessagingPort *mp){
@@ -70,6 +76,9 @@ namespace mongo {
         string _ip;
         bool _logConnect;
         long long _elapsedTime;
+        int _acceptThreads;
+
+        void acceptLoop( vector<int> socks , bool tracksTime );
 
         static const Listener* _timeTracker;
     };
@@ -83,6 +92,11 @@ namespace mongo {
         virtual HostAndPort remote() const = 0;
         virtual unsigned remotePort() const = 0;
 
+        /** compress what we send from now on (see util/compress.h); NoCompressor turns it off.
+            only for once the other side has said it can read dbCompressed messages.
+        */
+        virtual void setCompressor( int compressor ) { }
+
         virtual int getClientId(){
             int x = remotePort();
             x = x << 16;
@@ -110,6 +124,19 @@ namespace mongo {
            also, the Message data will go out of scope on the subsequent recv call.
         */
         bool recv(Message& m);
+
+#if !defined(_WIN32)
+        enum RecvState { RecvDone, RecvMore, RecvClosed };
+        /** read as much of the next message as has arrived, without blocking.  a partial message is kept
+            in the port until the rest comes, so m is only set when this returns RecvDone.  RecvClosed is
+            for the cases where recv() would return false.  don't mix with recv() on one port.
+        */
+        RecvState recvNonBlocking(Message& m);
+#endif
+        /* when the client has already sent its next request, a small reply is held back (see piggyBack)
+           and goes out in the same write as the replies after it.  held replies are sent before recv()
+           waits for more from the client.
+        */
         void reply(Message& received, Message& response, MSGID responseTo);
         void reply(Message& received, Message& response);
         bool call(Message& toSend, Message& response);
@@ -117,6 +144,9 @@ namespace mongo {
 
         void piggyBack( Message& toSend , int responseTo = -1 );
 
+        virtual void setCompressor( int compressor ) { _compressor = compressor; }
+        int getCompressor() const { return _compressor; }
+
         virtual unsigned remotePort() const;
         virtual HostAndPort remote() const;
 
@@ -124,11 +154,23 @@ namespace mongo {
         void send( const char * data , int len, const char *context );
         void send( const vector< pair< char *, int > > &data, const char *context );
 
+        /** one write of as much of data as the socket takes without blocking, after any replies held for
+            piggybacking.  for when the buffers are only good for a short while; the caller send()s the rest.
+            @return bytes of data written, 0 if none (always 0 on windows)
+        */
+        int sendNoWait( const vector< pair< char *, int > > &data, const char *context );
+
         // recv len or throw SocketException
         void recv( char * data , int len );
+
+        // one recv() of up to max bytes; at least 1 or throw SocketException
+        int recvSome( char * data , int max );
         
         int unsafe_recv( char *buf, int max );
 
+        /** for registering with select/epoll; -1 if not connected */
+        int getSocket() const { return sock; }
+
         void clearCounters() { _bytesIn = 0; _bytesOut = 0; }
         long long getBytesIn() const { return _bytesIn; }
         long long getBytesOut() const { return _bytesOut; }
@@ -139,6 +181,23 @@ namespace mongo {
         long long _bytesIn;
         long long _bytesOut;
 
+        int _compressor;
+
+        /* recv(Message&) reads as much as has arrived into here, up to RecvBufSize, so that a run of
+           small messages costs one syscall rather than two each.  [_rstart, _rend) is not yet used.
+        */
+        enum { RecvBufSize = 4096 };
+        char * _rbuf;
+        int _rstart;
+        int _rend;
+        void fill();
+        bool messageBuffered() const;
+
+        // the message recvNonBlocking() is part way through: its length is read into _partialLen first
+        MsgData * _partial;
+        int _partialLen;
+        int _partialHave;
+
     public:
         SockAddr farEnd;
         double _timeout;
@@ -161,7 +220,8 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        dbCompressed = 2012 /* another message, compressed.  MessagingPort unwraps these in recv() */
     };
 
     bool doesOpGetAResponse( int op );
@@ -177,6 +237,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default: 
             PRINT(op);
             assert(0); 
@@ -345,6 +406,7 @@ struct OP_GETMORE : public MSGHEADER {
             assert( r._freeIt );
             _buf = r._buf;
             r._buf = 0;
+            _bufOwner.swap( r._bufOwner );
             if ( r._data.size() > 0 ) {
                 _data.swap( r._data );
             }
@@ -355,7 +417,7 @@ struct OP_GETMORE : public MSGHEADER {
 
         void reset() {
             if ( _freeIt ) {
-                if ( _buf ) {
+                if ( _buf && !_bufOwner ) {
                     free( _buf );
                 }
                 for( vector< pair< char *, int > >::const_iterator i = _data.begin(); i != _data.end(); ++i ) {
@@ -363,10 +425,25 @@ struct OP_GETMORE : public MSGHEADER {
                 }
             }
             _buf = 0;
+            _bufOwner.reset();
             _data.clear();
             _freeIt = false;
         }
 
+        /** true if we own a single buffer, which we could hand to a shared owner */
+        bool canShareData() const { return _buf && _freeIt; }
+
+        /** the buffer's shared owner, once shareData() has been called; null before */
+        const boost::shared_ptr<void>& sharedData() const { return _bufOwner; }
+
+        /** from now on owner frees our single buffer, when the last reference to it goes, so that
+            objects pointing into the message can outlive it.  see DbMessage::shareBuffer().
+        */
+        void shareData( const boost::shared_ptr<void>& owner ) const {
+            assert( canShareData() && !_bufOwner );
+            _bufOwner = owner;
+        }
+
         // use to add a buffer
         // assumes message will free everything
         void appendData(char *d, int size) {
@@ -380,6 +457,7 @@ struct OP_GETMORE : public MSGHEADER {
                 return;
             }
             assert( _freeIt );
+            assert( !_bufOwner );
             if ( _buf ) {
                 _data.push_back( make_pair( (char*)_buf, _buf->len ) );
                 _buf = 0;
@@ -406,10 +484,34 @@ struct OP_GETMORE : public MSGHEADER {
             _setData( d, true );
         }
 
-        bool doIFreeIt() {
+        bool doIFreeIt() const {
             return _freeIt;
         }
 
+        /** true if the message is in one buffer, so singleData() can be used */
+        bool isSingleBuffer() const { return _buf != 0; }
+
+        /** add the message's buffers, in order, to a list for MessagingPort::send() */
+        void appendBuffers( vector< pair< char *, int > >& v ) const {
+            if ( _buf ) {
+                v.push_back( make_pair( (char*)_buf, _buf->len ) );
+                return;
+            }
+            v.insert( v.end(), _data.begin(), _data.end() );
+        }
+
+        /** copy all of the message's buffers, in order, to dest, which must have room for size() bytes */
+        void copyTo( char *dest ) const {
+            if ( _buf ) {
+                memcpy( dest, _buf, _buf->len );
+                return;
+            }
+            for( MsgVec::const_iterator i = _data.begin(); i != _data.end(); ++i ) {
+                memcpy( dest, i->first, i->second );
+                dest += i->second;
+            }
+        }
+
         void send( MessagingPort &p, const char *context ) {
             if ( empty() ) {
                 return;
@@ -432,6 +534,8 @@ struct OP_GETMORE : public MSGHEADER {
         typedef vector< pair< char*, int > > MsgVec;
         MsgVec _data;
         bool _freeIt;
+        // when set, frees _buf in our place (see shareData)
+        mutable boost::shared_ptr<void> _bufOwner;
     };
 
     class SocketException : public DBException {
@@ -448,6 +552,12 @@ struct OP_GETMORE : public MSGHEADER {
 
     MSGID nextMessageId();
 
+    /** server side of the compression handshake, for isMaster.  the client lists the compressors it can
+        read, as { isMaster : 1 , compression : [ "lz" ] }.  if we have one of them we name it in the reply,
+        and start compressing what we send to p.
+    */
+    void negotiateCompression( const BSONObj& isMasterCmd , BSONObjBuilder& result , AbstractMessagingPort * p );
+
     void setClientId( int id );
     int getClientId();
 
@@ -38,8 +38,9 @@ namespace mongo {
         struct Options {
             int port;                   // port to bind to
             string ipList;             // addresses to bind to
+            int workerThreads;          // >0: an epoll loop and this many threads serve all connections (linux).  0: a thread per connection
 
-            Options() : port(0), ipList(""){} 
+            Options() : port(0), ipList(""), workerThreads(0){} 
         };
 
         virtual ~MessageServer(){}
@@ -24,6 +24,11 @@
 
 #include "../db/cmdline.h"
 #include "../db/stats/counters.h"
+#include "concurrency/thread_pool.h"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
 
 namespace mongo {
 
@@ -73,6 +78,120 @@ namespace mongo {
             handler->disconnected( p.get() );
         }
 
+#if defined(__linux__)
+        /* the alternative to a thread per connection (see MessageServer::Options::workerThreads): one
+           thread waits in epoll for any connection to have data, reads what has arrived without
+           blocking, and when a whole message is in hands it to a fixed pool of workers, which process
+           it and reply as usual -- the socket itself stays blocking, only our reads are MSG_DONTWAIT.
+           connections are registered EPOLLONESHOT and only rearmed once their message is processed,
+           so each connection's requests still run one at a time and in order, and a connection
+           belongs to exactly one thread at any moment.
+        */
+        class EpollDispatcher : boost::noncopyable {
+        public:
+            EpollDispatcher( int nWorkers ) : _workers( nWorkers ) {
+                _epfd = epoll_create( 1024 );
+                massert( 13621 , string( "epoll_create failed: " ) + errnoWithDescription() , _epfd >= 0 );
+            }
+
+            void start() {
+                boost::thread thr( boost::bind( &EpollDispatcher::run , this ) );
+            }
+
+            /** takes ownership of p, which holds a connTicketHolder ticket */
+            void add( MessagingPort * p ){
+                Conn * c = new Conn( p );
+                if ( ! arm( c , EPOLL_CTL_ADD ) ){
+                    log() << "can't add connection to epoll: " << errnoWithDescription() << endl;
+                    close( c );
+                }
+            }
+
+        private:
+            struct Conn {
+                Conn( MessagingPort * p ) : port( p ) {}
+                MessagingPort * port;
+                Message m; // the request being read or processed
+            };
+
+            bool arm( Conn * c , int op ){
+                epoll_event e;
+                memset( &e , 0 , sizeof( e ) );
+                e.events = EPOLLIN | EPOLLONESHOT;
+                e.data.ptr = c;
+                return epoll_ctl( _epfd , op , c->port->getSocket() , &e ) == 0;
+            }
+
+            void run(){
+                setThreadName( "connEpoll" );
+                const int maxEvents = 256;
+                epoll_event events[maxEvents];
+                while ( ! inShutdown() ){
+                    int n = epoll_wait( _epfd , events , maxEvents , 1000 );
+                    if ( n < 0 ){
+                        if ( errno != EINTR ){
+                            log() << "epoll_wait failed: " << errnoWithDescription() << endl;
+                            sleepmillis( 10 );
+                        }
+                        continue;
+                    }
+                    for ( int i = 0; i < n; i++ )
+                        readable( (Conn *) events[i].data.ptr );
+                }
+            }
+
+            void readable( Conn * c ){
+                switch ( c->port->recvNonBlocking( c->m ) ){
+                case MessagingPort::RecvDone:
+                    _workers.schedule( &EpollDispatcher::process , this , c );
+                    return;
+                case MessagingPort::RecvMore:
+                    if ( arm( c , EPOLL_CTL_MOD ) )
+                        return;
+                    break;
+                case MessagingPort::RecvClosed:
+                    if( !cmdLine.quiet )
+                        log() << "end connection " << c->port->farEnd.toString() << endl;
+                    break;
+                }
+                close( c );
+            }
+
+            void process( Conn * c ){
+                try {
+                    handler->process( c->m , c->port );
+                    networkCounter.hit( c->port->getBytesIn() , c->port->getBytesOut() );
+                    c->port->clearCounters();
+                    c->m.reset();
+                    if ( arm( c , EPOLL_CTL_MOD ) )
+                        return;
+                }
+                catch ( const SocketException& ){
+                    log() << "unclean socket shutdown from: " << c->port->farEnd.toString() << endl;
+                }
+                catch ( const std::exception& e ){
+                    problem() << "uncaught exception (" << e.what() << ")(" << demangleName( typeid(e) ) <<") in PortMessageServer worker, closing connection" << endl;
+                }
+                catch ( ... ){
+                    problem() << "uncaught exception in PortMessageServer worker, closing connection" << endl;
+                }
+                close( c );
+            }
+
+            /** only by the thread the connection currently belongs to; closing the socket takes it out of epoll */
+            void close( Conn * c ){
+                handler->disconnected( c->port );
+                c->port->shutdown();
+                delete c->port;
+                delete c;
+                connTicketHolder.release();
+            }
+
+            int _epfd;
+            ThreadPool _workers;
+        };
+#endif
+
     }
 
     class PortMessageServer : public MessageServer , public Listener {
@@ -82,6 +201,15 @@ namespace mongo {
             
             uassert( 10275 ,  "multiple PortMessageServer not supported" , ! pms::handler );
             pms::handler = handler;
+            setAcceptThreads( cmdLine.acceptThreads );
+
+            if ( opts.workerThreads > 0 ){
+#if defined(__linux__)
+                _dispatcher.reset( new pms::EpollDispatcher( opts.workerThreads ) );
+#else
+                log() << "worker threads are only supported on linux, using a thread per connection" << endl;
+#endif
+            }
         }
         
         virtual void accepted(MessagingPort * p) {
@@ -97,6 +225,13 @@ namespace mongo {
                 return;
             }
 
+#if defined(__linux__)
+            if ( _dispatcher.get() ){
+                _dispatcher->add( p );
+                return;
+            }
+#endif
+
             try {
                 boost::thread thr( boost::bind( &pms::threadRun , p ) );
             }
@@ -115,9 +250,17 @@ namespace mongo {
         }
 
         void run(){
+#if defined(__linux__)
+            if ( _dispatcher.get() )
+                _dispatcher->start();
+#endif
             initAndListen();
         }
 
+    private:
+#if defined(__linux__)
+        auto_ptr<pms::EpollDispatcher> _dispatcher;
+#endif
     };
 
 
@@ -47,7 +47,20 @@ namespace mongo {
         if (!strcmp(iporhost, "localhost"))
             iporhost = "127.0.0.1";
 
-        if (strchr(iporhost, '/')){
+        if (iporhost[0] == '@'){
+#if defined(__linux__)
+            // linux abstract namespace: like a path, but no file, and gone with the last socket
+            size_t len = strlen(iporhost + 1);
+            uassert(13622, "name of abstract unix socket too long", len + 1 < sizeof(as<sockaddr_un>().sun_path));
+            as<sockaddr_un>().sun_family = AF_UNIX;
+            as<sockaddr_un>().sun_path[0] = '\0';
+            memcpy(as<sockaddr_un>().sun_path + 1, iporhost + 1, len);
+            addressSize = offsetof(sockaddr_un, sun_path) + 1 + len;
+#else
+            uassert(13623, "abstract unix sockets (@name) are only supported on linux", false);
+#endif
+        }
+        else if (strchr(iporhost, '/')){
 #ifdef _WIN32
             uassert(13080, "no unix socket support on windows", false);
 #endif
@@ -176,7 +176,7 @@ namespace mongo {
                     return buffer;
                 }
 
-                case AF_UNIX:  return (addressSize > 2 ? as<sockaddr_un>().sun_path : "anonymous unix socket");
+                case AF_UNIX:  return getUnixAddr();
                 case AF_UNSPEC: return "(NONE)";
                 default: massert(SOCK_FAMILY_UNKNOWN_ERROR, "unsupported address family", false); return "";
             }
@@ -194,7 +194,7 @@ namespace mongo {
             switch (getType()){
                 case AF_INET:  return as<sockaddr_in>().sin_addr.s_addr == r.as<sockaddr_in>().sin_addr.s_addr;
                 case AF_INET6: return memcmp(as<sockaddr_in6>().sin6_addr.s6_addr, r.as<sockaddr_in6>().sin6_addr.s6_addr, sizeof(in6_addr)) == 0;
-                case AF_UNIX:  return strcmp(as<sockaddr_un>().sun_path, r.as<sockaddr_un>().sun_path) == 0;
+                case AF_UNIX:  return getUnixAddr() == r.getUnixAddr();
                 case AF_UNSPEC: return true; // assume all unspecified addresses are the same
                 default: massert(SOCK_FAMILY_UNKNOWN_ERROR, "unsupported address family", false);
             }
@@ -216,7 +216,7 @@ namespace mongo {
             switch (getType()){
                 case AF_INET:  return as<sockaddr_in>().sin_addr.s_addr < r.as<sockaddr_in>().sin_addr.s_addr;
                 case AF_INET6: return memcmp(as<sockaddr_in6>().sin6_addr.s6_addr, r.as<sockaddr_in6>().sin6_addr.s6_addr, sizeof(in6_addr)) < 0;
-                case AF_UNIX:  return strcmp(as<sockaddr_un>().sun_path, r.as<sockaddr_un>().sun_path) < 0;
+                case AF_UNIX:  return getUnixAddr() < r.getUnixAddr();
                 case AF_UNSPEC: return false;
                 default: massert(SOCK_FAMILY_UNKNOWN_ERROR, "unsupported address family", false);
             }
@@ -227,6 +227,17 @@ namespace mongo {
 
         socklen_t addressSize;
         private:
+        /* a path, or @name for a socket in linux's abstract namespace: sun_path starts with a 0 there */
+        string getUnixAddr() const {
+            const size_t pathOffset = offsetof(sockaddr_un, sun_path);
+            if ((size_t) addressSize <= pathOffset)
+                return "anonymous unix socket";
+            const char *path = as<sockaddr_un>().sun_path;
+            if (path[0])
+                return path;
+            return "@" + string(path + 1, addressSize - pathOffset - 1);
+        }
+
         struct sockaddr_storage sa;
     };
 